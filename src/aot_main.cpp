@@ -0,0 +1,73 @@
+#include "machine.hpp"
+#include "recompiled_runtime.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[])
+{
+    int32_t cycles {1000000};
+    bool    interpret {false};
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--cycles") == 0 && i + 1 < argc)
+        {
+            cycles = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--interpret") == 0)
+        {
+            interpret = true;
+        }
+        else
+        {
+            std::cout << "Usage: 8chip_aot [--cycles N] [--interpret]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    chip8::cMachine machine;
+    chip8::cRam&    ram = *machine.get_ram();
+    if (ram.load_rom(chip8::RECOMPILED_ROM, chip8::RECOMPILED_ROM_SIZE) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    chip8::cDisplay&   display = *machine.get_display();
+    chip8::cKeyboard&  keyboard = *machine.get_keyboard();
+    chip8::cTimer&     delay_timer = *machine.get_delay_timer();
+    chip8::cTimer&     sound_timer = *machine.get_sound_timer();
+    chip8::cProcessor& processor = *machine.get_processor();
+
+    chip8::cRecompiledRunner runner {&processor, &ram};
+
+    auto    start = std::chrono::steady_clock::now();
+    int32_t executed = 0;
+
+    if (interpret)
+    {
+        processor.set_dispatch_mode(chip8::cProcessor::eDispatchMode::decode_cache);
+        executed = processor.run_cycles(cycles, &ram, &display, &keyboard, &delay_timer, &sound_timer);
+    }
+    else
+    {
+        executed = runner.run_cycles(cycles, &ram, &display, &keyboard, &delay_timer, &sound_timer);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("[INFO] Executed %d instructions in %.3f s (%.0f instructions/s)\n", executed, elapsed.count(), executed / elapsed.count());
+    std::printf("[INFO] Native %lld, interpreted %lld\n", static_cast<long long>(runner.get_native_cycles()), static_cast<long long>(runner.get_interpreted_cycles()));
+    std::printf("[INFO] PC=%04x I=%04x V=", processor.get_program_counter(), processor.get_register_i());
+    for (int32_t i = 0; i < chip8::REGISTER_COUNT; i++)
+    {
+        std::printf("%02x ", processor.get_register(i));
+    }
+    std::printf("\n");
+
+    return EXIT_SUCCESS;
+}
@@ -1,104 +1,272 @@
 #include "display.hpp"
+#include "machine_state.hpp"
 
 #include <algorithm>
-#include <iostream>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
 
 namespace chip8
 {
-    cDisplay::cDisplay(int32_t height, int32_t width)
+    namespace
     {
-        _height = height;
-        _width = width;
-        _pixels.reserve(_height * _width);
+        uint64_t blit_scalar(uint64_t* rows, const uint64_t* sprite, int32_t word_count)
+        {
+            uint64_t collisions = 0U;
+
+            for (int32_t i = 0; i < word_count; i++)
+            {
+                collisions |= rows[i] & sprite[i];
+                rows[i] ^= sprite[i];
+            }
 
-        for (uint32_t i = 0U; i < _width * _height; i++)
+            return collisions;
+        }
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CHIP8_SIMD_BLIT 1
+
+        __attribute__((target("sse2"))) uint64_t blit_sse2(uint64_t* rows, const uint64_t* sprite, int32_t word_count)
         {
-            _pixels.push_back(0);
+            __m128i collisions = _mm_setzero_si128();
+            int32_t i = 0;
+
+            for (; i + 2 <= word_count; i += 2)
+            {
+                __m128i screen = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows + i));
+                __m128i bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sprite + i));
+                collisions = _mm_or_si128(collisions, _mm_and_si128(screen, bits));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(rows + i), _mm_xor_si128(screen, bits));
+            }
+
+            alignas(16) uint64_t lanes[2];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), collisions);
+            return lanes[0] | lanes[1] | blit_scalar(rows + i, sprite + i, word_count - i);
         }
 
-        assert(_pixels.size() == _width * _height);
+        __attribute__((target("avx2"))) uint64_t blit_avx2(uint64_t* rows, const uint64_t* sprite, int32_t word_count)
+        {
+            __m256i collisions = _mm256_setzero_si256();
+            int32_t i = 0;
+
+            for (; i + 4 <= word_count; i += 4)
+            {
+                __m256i screen = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows + i));
+                __m256i bits = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sprite + i));
+                collisions = _mm256_or_si256(collisions, _mm256_and_si256(screen, bits));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(rows + i), _mm256_xor_si256(screen, bits));
+            }
+
+            alignas(32) uint64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), collisions);
+            return lanes[0] | lanes[1] | lanes[2] | lanes[3] | blit_sse2(rows + i, sprite + i, word_count - i);
+        }
+#else
+#define CHIP8_SIMD_BLIT 0
+#endif
+    }
+
+    cDisplay::cDisplay(int32_t height, int32_t width)
+      : _owned_rows(height * ((width + 63) / 64), 0U)
+      , _height(height)
+      , _width(width)
+      , _renderer(height, width)
+    {
+        init(_owned_rows.data());
+    }
+
+    cDisplay::cDisplay(sMachineState* state)
+      : _height(DISPLAY_HEIGHT)
+      , _width(DISPLAY_WIDTH)
+      , _renderer(DISPLAY_HEIGHT, DISPLAY_WIDTH)
+    {
+        init(state->rows);
+    }
+
+    void cDisplay::init(uint64_t* rows)
+    {
+        _words_per_row = (_width + 63) / 64;
+
+        _rows = rows;
+        _sprite_words.assign(MAX_SPRITE_HEIGHT * _words_per_row, 0U);
+        _dirty_rows.assign(_height, 0U);
+
+        set_blit_kernel(get_best_blit_kernel());
     }
 
     void cDisplay::draw_frame()
     {
-        clear_terminal();
-        print_pixels();
+        _renderer.render(_rows, &_dirty_rows);
+        std::fill(_dirty_rows.begin(), _dirty_rows.end(), 0U);
     }
 
     void cDisplay::clear_pixels()
     {
-        for (uint32_t i = 0U; i < _width * _height; i++)
-        {
-            _pixels[i] = 0;
-        }
+        std::fill(_rows, _rows + _height * _words_per_row, 0U);
+        mark_dirty();
     }
 
-    void cDisplay::draw_byte(uint8_t sprite_initial_x, uint8_t y, uint8_t byte, bool* flipped_bit)
+    void cDisplay::mark_dirty()
     {
-        // We don't draw past the edge of the screen.
-        if (y >= _height)
-        {
-            return;
-        }
+        std::fill(_dirty_rows.begin(), _dirty_rows.end(), 1U);
+    }
+
+    cTerminalRenderer& cDisplay::get_renderer()
+    {
+        return _renderer;
+    }
+
+    bool cDisplay::draw_sprite(uint8_t x, uint8_t y, const uint8_t* sprite_rows, int32_t sprite_height)
+    {
+        assert(sprite_height <= MAX_SPRITE_HEIGHT);
 
-        bool flipped_any_bit = false;
+        int32_t start_x = x % _width;
+        int32_t start_y = y % _height;
 
-        // We don't draw past the edge of the screen.
-        uint8_t sprite_final_x = std::min(_width, sprite_initial_x + 8);
-        uint8_t sprite_width = sprite_final_x - sprite_initial_x;
+        // Pixels of the sprite that fit before the right edge.
+        int32_t  visible_width = std::min(8, _width - start_x);
+        uint8_t  visible_mask = static_cast<uint8_t>(0xFF << (8 - visible_width));
+        bool     wrap = _sprite_edge == eSpriteEdge::wrap;
+        int32_t  sprite_word_count = sprite_height * _words_per_row;
+        uint64_t* sprite = _sprite_words.data();
 
-        for (uint8_t i = 0; i < sprite_width; i++)
+        // Line every sprite row up with the framebuffer words it covers, so the blit is a plain run of words.
+        std::fill(sprite, sprite + sprite_word_count, 0U);
+
+        for (int32_t i = 0; i < sprite_height; i++)
         {
-            uint8_t current_sprite_pixel = (byte >> (7 - i)) & 0b1;
-            size_t  current_display_location = y * _width + sprite_initial_x + i;
-            uint8_t current_display_pixel = static_cast<uint8_t>(_pixels[current_display_location]);
+            uint64_t* sprite_row = sprite + i * _words_per_row;
+            place_sprite_byte(sprite_row, start_x, sprite_rows[i] & visible_mask);
 
-            if (current_sprite_pixel && current_display_pixel)
+            if (wrap && visible_width < 8)
             {
-                flipped_any_bit = true;
-                _pixels[current_display_location] = 0;
+                place_sprite_byte(sprite_row, 0, static_cast<uint8_t>(sprite_rows[i] << visible_width));
             }
+        }
+
+        // Rows past the bottom are either dropped or continue from the top. Each run of rows is contiguous in memory.
+        uint64_t collisions = 0U;
+        int32_t  row = start_y;
+        int32_t  drawn_rows = 0;
 
-            if (current_sprite_pixel && !current_display_pixel)
+        while (drawn_rows < sprite_height)
+        {
+            int32_t run_rows = std::min(sprite_height - drawn_rows, _height - row);
+            collisions |= _blit(&_rows[row * _words_per_row], sprite + drawn_rows * _words_per_row, run_rows * _words_per_row);
+            std::fill(_dirty_rows.begin() + row, _dirty_rows.begin() + row + run_rows, 1U);
+            drawn_rows += run_rows;
+            row = 0;
+
+            if (!wrap)
             {
-                _pixels[current_display_location] = 1;
+                break;
             }
         }
 
-        *flipped_bit = flipped_any_bit;
+        return collisions != 0U;
     }
 
-    int32_t cDisplay::get_height()
+    void cDisplay::place_sprite_byte(uint64_t* row, int32_t x, uint8_t byte) const
     {
-        return _height;
+        // The byte may straddle two words. Callers mask off pixels past the right edge, so the last word of a row
+        // has nothing to spill into the next one, which belongs to the following row or lies past the buffer.
+        int32_t  word_index = x / 64;
+        int32_t  bit_offset = x % 64;
+        uint64_t sprite_bits = static_cast<uint64_t>(byte) << 56;
+
+        row[word_index] |= sprite_bits >> bit_offset;
+
+        if (bit_offset > 56 && word_index + 1 < _words_per_row)
+        {
+            row[word_index + 1] |= sprite_bits << (64 - bit_offset);
+        }
     }
 
-    int32_t cDisplay::get_width()
+    void cDisplay::set_sprite_edge(eSpriteEdge edge)
     {
-        return _width;
+        _sprite_edge = edge;
     }
 
-    void cDisplay::clear_terminal()
+    cDisplay::eSpriteEdge cDisplay::get_sprite_edge() const
     {
-        std::cout << "\e[1;1H\e[2J";
+        return _sprite_edge;
     }
 
-    void cDisplay::print_pixels()
+    bool cDisplay::set_blit_kernel(eBlitKernel kernel)
     {
-        std::string ascii_display {};
-        ascii_display.reserve(_height * _width + _height);
-
-        for (int y = 0; y < _height; y++)
+        switch (kernel)
         {
-            for (int x = 0; x < _width; x++)
+            case eBlitKernel::scalar:
+            {
+                _blit = blit_scalar;
+            }
+            break;
+#if CHIP8_SIMD_BLIT
+            case eBlitKernel::sse2:
             {
-                int current_pixel = _pixels[y * _width + x];
-                ascii_display += current_pixel == 0 ? EMPTY_PIXEL_CHAR : FULL_PIXEL_CHAR;
+                _blit = blit_sse2;
             }
+            break;
+            case eBlitKernel::avx2:
+            {
+                if (!__builtin_cpu_supports("avx2"))
+                {
+                    return false;
+                }
 
-            ascii_display += '\n';
+                _blit = blit_avx2;
+            }
+            break;
+#endif
+            default:
+            {
+                return false;
+            }
         }
 
-        std::cout << ascii_display;
+        _blit_kernel = kernel;
+        return true;
+    }
+
+    cDisplay::eBlitKernel cDisplay::get_blit_kernel() const
+    {
+        return _blit_kernel;
+    }
+
+    cDisplay::eBlitKernel cDisplay::get_best_blit_kernel()
+    {
+#if CHIP8_SIMD_BLIT
+        return __builtin_cpu_supports("avx2") ? eBlitKernel::avx2 : eBlitKernel::sse2;
+#else
+        return eBlitKernel::scalar;
+#endif
+    }
+
+    int32_t cDisplay::get_height() const
+    {
+        return _height;
+    }
+
+    int32_t cDisplay::get_width() const
+    {
+        return _width;
+    }
+
+    bool cDisplay::get_pixel(int32_t x, int32_t y) const
+    {
+        assert(x < _width && y < _height);
+        uint64_t word = _rows[y * _words_per_row + x / 64];
+        return (word >> (63 - x % 64)) & 0b1;
+    }
+
+    int32_t cDisplay::get_words_per_row() const
+    {
+        return _words_per_row;
+    }
+
+    const uint64_t* cDisplay::get_rows() const
+    {
+        return _rows;
     }
 }
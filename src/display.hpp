@@ -1,6 +1,8 @@
 #ifndef CHIP8_SRC_DISPLAYHPP
 #define CHIP8_SRC_DISPLAYHPP
 
+#include "terminal_renderer.hpp"
+
 #include <assert.h>
 #include <cstdint>
 #include <vector>
@@ -9,30 +11,83 @@ namespace chip8
 {
     constexpr int32_t DISPLAY_WIDTH = 64;
     constexpr int32_t DISPLAY_HEIGHT = 32;
+    constexpr int32_t DISPLAY_WORDS_PER_ROW = (DISPLAY_WIDTH + 63) / 64;
+
+    constexpr int32_t MAX_SPRITE_HEIGHT = 16;
 
-    constexpr char EMPTY_PIXEL_CHAR = '.';
-    constexpr char FULL_PIXEL_CHAR = '#';
+    struct sMachineState;
 
+    // Framebuffer is bit-packed. Each row is a run of 64 bit words, leftmost pixel in the most significant bit.
     class cDisplay
     {
       public:
+        // What happens to the parts of a sprite that go past the right or bottom edge. The start coordinate always wraps.
+        enum class eSpriteEdge
+        {
+            clip,
+            wrap,
+        };
+
+        // Kernel XORing sprites into the framebuffer. All of them produce the same result.
+        enum class eBlitKernel
+        {
+            scalar,
+            sse2,
+            avx2,
+        };
+
+        // Standalone, owns only a framebuffer of the given size.
         cDisplay(int32_t height, int32_t width);
+        // View over the framebuffer of the given state, DISPLAY_WIDTH by DISPLAY_HEIGHT.
+        explicit cDisplay(sMachineState* state);
 
+        // Only redraws the rows written to since the last frame, in a single write.
         void draw_frame();
         void clear_pixels();
 
-        void draw_byte(uint8_t sprite_initial_x, uint8_t y, uint8_t byte, bool* flipped_bit);
+        // For changes made to the state behind the display's back, like restoring a snapshot. The next frame redraws every row.
+        void mark_dirty();
+
+        // Renderer used by draw_frame.
+        cTerminalRenderer& get_renderer();
+
+        // XORs sprite_height rows of 8 pixels (at most MAX_SPRITE_HEIGHT) into the screen at x, y.
+        // Returns true if any pixel was flipped from set to unset.
+        bool draw_sprite(uint8_t x, uint8_t y, const uint8_t* sprite_rows, int32_t sprite_height);
 
-        int32_t get_height();
-        int32_t get_width();
+        void        set_sprite_edge(eSpriteEdge edge);
+        eSpriteEdge get_sprite_edge() const;
+
+        // Defaults to the fastest kernel the host supports. Returns false if the host lacks the requested one.
+        bool               set_blit_kernel(eBlitKernel kernel);
+        eBlitKernel        get_blit_kernel() const;
+        static eBlitKernel get_best_blit_kernel();
+
+        int32_t get_height() const;
+        int32_t get_width() const;
+
+        bool            get_pixel(int32_t x, int32_t y) const;
+        int32_t         get_words_per_row() const;
+        const uint64_t* get_rows() const; // get_height() * get_words_per_row() words.
 
       private:
-        void clear_terminal();
-        void print_pixels();
+        using tBlitFunction = uint64_t (*)(uint64_t* rows, const uint64_t* sprite, int32_t word_count); // Returns the collided bits.
+
+        void init(uint64_t* rows);
+        void place_sprite_byte(uint64_t* row, int32_t x, uint8_t byte) const;
+
+        std::vector<uint64_t> _owned_rows; // Empty for a view.
+        int32_t               _height;
+        int32_t               _width;
+        int32_t               _words_per_row;
+        uint64_t*             _rows; // Rows of the machine state, or the owned ones.
+        std::vector<uint64_t> _sprite_words; // Sprite lined up with the framebuffer, MAX_SPRITE_HEIGHT rows.
+        eSpriteEdge           _sprite_edge {eSpriteEdge::clip};
+        eBlitKernel           _blit_kernel {eBlitKernel::scalar};
+        tBlitFunction         _blit {nullptr};
 
-        int32_t              _height;
-        int32_t              _width;
-        std::vector<int32_t> _pixels;
+        std::vector<uint8_t> _dirty_rows; // Rows written to since the last frame.
+        cTerminalRenderer    _renderer;
     };
 }
 
@@ -0,0 +1,185 @@
+#include "farm.hpp"
+
+#include "display.hpp"
+#include "headless.hpp"
+#include "keyboard.hpp"
+#include "machine.hpp"
+#include "processor.hpp"
+#include "ram.hpp"
+#include "save_state.hpp"
+#include "scheduler.hpp"
+#include "timer.hpp"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <utility>
+
+namespace chip8
+{
+    namespace
+    {
+        std::string resolve_path(const std::filesystem::path& base_directory, const std::string& path)
+        {
+            std::filesystem::path resolved {path};
+            return resolved.is_absolute() ? path : (base_directory / resolved).string();
+        }
+
+        int32_t read_file(const std::string& path, std::vector<uint8_t>* bytes)
+        {
+            std::ifstream file {path, std::ios::binary | std::ios::in};
+            if (!file.is_open())
+            {
+                return -1;
+            }
+
+            bytes->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            return 0;
+        }
+    }
+
+    int32_t load_farm_manifest(const std::string& path, std::vector<sFarmJob>* jobs)
+    {
+        std::ifstream file {path};
+        if (!file.is_open())
+        {
+            return -1;
+        }
+
+        std::filesystem::path base_directory = std::filesystem::path(path).parent_path();
+        std::string           line;
+
+        while (std::getline(file, line))
+        {
+            if (is_skipped_line(line))
+            {
+                continue;
+            }
+
+            std::istringstream fields {line};
+            sFarmJob           job {};
+
+            if (!(fields >> job.rom_path >> job.input_path >> job.cycle_budget) || job.cycle_budget < 0)
+            {
+                return -1;
+            }
+
+            std::string seed;
+            job.seeded = static_cast<bool>(fields >> seed);
+            job.random_seed = job.seeded ? std::strtoull(seed.c_str(), nullptr, 0) : DEFAULT_RANDOM_SEED;
+
+            job.rom_path = resolve_path(base_directory, job.rom_path);
+            job.input_path = job.input_path == "-" ? "" : resolve_path(base_directory, job.input_path);
+            jobs->push_back(job);
+        }
+
+        return 0;
+    }
+
+    sFarmResult run_farm_job(const sFarmJob& job, int32_t instructions_per_second)
+    {
+        sFarmResult result {};
+
+        std::vector<uint8_t> rom;
+        if (read_file(job.rom_path, &rom) != 0)
+        {
+            result.error = "can not read rom";
+            return result;
+        }
+
+        std::vector<sInputEvent> events;
+        if (!job.input_path.empty() && load_input_script(job.input_path, &events) != 0)
+        {
+            result.error = "can not read input script";
+            return result;
+        }
+
+        cMachine machine;
+        cRam&    ram = *machine.get_ram();
+        bool     from_state = is_save_state(rom.data(), static_cast<int32_t>(rom.size()));
+
+        // Jobs sharing a post-boot save state skip the boot sequence.
+        if (from_state && machine.load_state(rom.data(), static_cast<int32_t>(rom.size())) < 0)
+        {
+            result.error = "invalid save state";
+            return result;
+        }
+
+        if (!from_state && ram.load_rom(rom.data(), static_cast<int32_t>(rom.size())) != 0)
+        {
+            result.error = "rom does not fit in ram";
+            return result;
+        }
+
+        cDisplay&   display = *machine.get_display();
+        cKeyboard&  keyboard = *machine.get_keyboard();
+        cTimer&     delay_timer = *machine.get_delay_timer();
+        cTimer&     sound_timer = *machine.get_sound_timer();
+        cProcessor& processor = *machine.get_processor();
+        if (job.seeded || !from_state)
+        {
+            processor.set_random_seed(job.random_seed);
+        }
+
+        cScheduler scheduler {instructions_per_second, cScheduler::ePacing::unthrottled};
+
+        cInputPlayback playback {std::move(events)};
+        playback.apply_due_events(0, &keyboard);
+        scheduler.set_frame_listener([&scheduler, &playback, &keyboard]() { playback.apply_due_events(scheduler.get_frames(), &keyboard); });
+
+        auto start = std::chrono::steady_clock::now();
+        result.executed = scheduler.run(job.cycle_budget, INT64_MAX, &processor, &ram, &display, &keyboard, &delay_timer, &sound_timer);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        result.frames = scheduler.get_frames();
+        result.seconds = elapsed.count();
+        result.state_hash = hash_machine_state(&processor, &ram, &display, &delay_timer, &sound_timer);
+        result.rows.assign(display.get_rows(), display.get_rows() + display.get_height() * display.get_words_per_row());
+
+        return result;
+    }
+
+    int32_t write_farm_results(const std::string& path, const std::vector<sFarmJob>& jobs, const std::vector<sFarmResult>& results)
+    {
+        FILE* file = std::fopen(path.c_str(), "w");
+        if (file == nullptr)
+        {
+            return -1;
+        }
+
+        std::fprintf(file, "# rom state_hash cycles frames instructions_per_second framebuffer\n");
+
+        for (size_t i = 0; i < jobs.size(); i++)
+        {
+            const sFarmResult& result = results[i];
+
+            if (!result.error.empty())
+            {
+                std::fprintf(file, "%s error %s\n", jobs[i].rom_path.c_str(), result.error.c_str());
+                continue;
+            }
+
+            std::fprintf(file,
+                         "%s %016" PRIx64 " %" PRId64 " %" PRId64 " %.0f ",
+                         jobs[i].rom_path.c_str(),
+                         result.state_hash,
+                         result.executed,
+                         result.frames,
+                         result.seconds > 0.0 ? result.executed / result.seconds : 0.0);
+
+            for (uint64_t row_word : result.rows)
+            {
+                std::fprintf(file, "%016" PRIx64, row_word);
+            }
+
+            std::fprintf(file, "\n");
+        }
+
+        return std::fclose(file) == 0 ? 0 : -1;
+    }
+}
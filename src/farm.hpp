@@ -0,0 +1,44 @@
+#ifndef CHIP8_SRC_FARMHPP
+#define CHIP8_SRC_FARMHPP
+
+#include "input_script.hpp"
+#include "random.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace chip8
+{
+    struct sFarmJob
+    {
+        std::string rom_path;     // A ROM, or a save state to start from instead of booting.
+        std::string input_path;   // Input script, see load_input_script. Empty for no input.
+        int64_t     cycle_budget; // Cycles to run for, see cScheduler::run.
+        uint64_t    random_seed;
+        bool        seeded;       // False when the manifest gave no seed. Save states then keep their generator.
+    };
+
+    struct sFarmResult
+    {
+        std::string           error; // Empty if the job ran.
+        int64_t               executed {0};
+        int64_t               frames {0};
+        double                seconds {0.0};
+        uint64_t              state_hash {0U}; // See hash_machine_state.
+        std::vector<uint64_t> rows;            // Final framebuffer, see cDisplay::get_rows.
+    };
+
+    // Manifest lines are "<rom or save state> <input script> <cycle budget> [random seed]", with "-" for no input script.
+    // Relative paths start from the manifest's directory. Empty lines and lines starting with # are skipped.
+    // Returns -1 if the manifest can not be read or a line is malformed.
+    int32_t load_farm_manifest(const std::string& path, std::vector<sFarmJob>* jobs);
+
+    // Runs the job on instances of its own, unthrottled, so any number of jobs can run at once.
+    sFarmResult run_farm_job(const sFarmJob& job, int32_t instructions_per_second);
+
+    // One line per job, in manifest order. Returns -1 if the file can not be written.
+    int32_t write_farm_results(const std::string& path, const std::vector<sFarmJob>& jobs, const std::vector<sFarmResult>& results);
+}
+
+#endif // CHIP8_SRC_FARMHPP
@@ -0,0 +1,91 @@
+#include "farm.hpp"
+#include "scheduler.hpp"
+#include "work_pool.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// Runs every job of a manifest on its own emulator instances, spread over all cores, and writes one result file.
+int main(int argc, char* argv[])
+{
+    int32_t     thread_count {0};
+    int32_t     instructions_per_second {chip8::DEFAULT_INSTRUCTIONS_PER_SECOND};
+    const char* manifest_path {nullptr};
+    const char* output_path {nullptr};
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strncmp(argv[i], "--threads=", 10) == 0)
+        {
+            thread_count = std::atoi(argv[i] + 10);
+        }
+        else if (std::strncmp(argv[i], "--ips=", 6) == 0 && std::atoi(argv[i] + 6) > 0)
+        {
+            instructions_per_second = std::atoi(argv[i] + 6);
+        }
+        else if (manifest_path == nullptr && argv[i][0] != '-')
+        {
+            manifest_path = argv[i];
+        }
+        else if (output_path == nullptr && argv[i][0] != '-')
+        {
+            output_path = argv[i];
+        }
+        else
+        {
+            manifest_path = nullptr;
+            break;
+        }
+    }
+
+    if (manifest_path == nullptr || output_path == nullptr)
+    {
+        std::cout << "Usage: 8chip_farm <manifest> <output> [--threads=N] [--ips=N]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<chip8::sFarmJob> jobs;
+    if (chip8::load_farm_manifest(manifest_path, &jobs) != 0)
+    {
+        std::cout << "[ERROR] Can not read manifest " << manifest_path << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Every job writes its own slot, so the results need no locking.
+    std::vector<chip8::sFarmResult> results(jobs.size());
+    chip8::cWorkStealingPool        pool {thread_count};
+
+    auto start = std::chrono::steady_clock::now();
+    pool.run(static_cast<int64_t>(jobs.size()),
+             [&jobs, &results, instructions_per_second](int64_t job_index) { results[job_index] = chip8::run_farm_job(jobs[job_index], instructions_per_second); });
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (chip8::write_farm_results(output_path, jobs, results) != 0)
+    {
+        std::cout << "[ERROR] Can not write results to " << output_path << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int64_t failed = 0;
+    int64_t executed = 0;
+    for (const chip8::sFarmResult& result : results)
+    {
+        failed += result.error.empty() ? 0 : 1;
+        executed += result.executed;
+    }
+
+    std::printf("[INFO] Ran %zu jobs (%lld failed) on %d threads in %.3f s, %.0f instructions/s overall, %lld jobs stolen\n",
+                jobs.size(),
+                static_cast<long long>(failed),
+                pool.get_thread_count(),
+                elapsed.count(),
+                elapsed.count() > 0.0 ? executed / elapsed.count() : 0.0,
+                static_cast<long long>(pool.get_stolen_jobs()));
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
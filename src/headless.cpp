@@ -0,0 +1,129 @@
+#include "headless.hpp"
+
+#include "display.hpp"
+#include "input_script.hpp"
+#include "processor.hpp"
+#include "ram.hpp"
+#include "scheduler.hpp"
+#include "timer.hpp"
+
+#include <chrono>
+#include <vector>
+
+namespace chip8
+{
+    namespace
+    {
+        constexpr uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325ULL;
+        constexpr uint64_t FNV_PRIME = 0x100000001B3ULL;
+
+        void hash_byte(uint64_t* hash, uint8_t byte)
+        {
+            *hash = (*hash ^ byte) * FNV_PRIME;
+        }
+
+        void hash_word(uint64_t* hash, uint64_t word, int32_t bytes)
+        {
+            for (int32_t i = 0; i < bytes; i++)
+            {
+                hash_byte(hash, static_cast<uint8_t>(word >> (8 * i)));
+            }
+        }
+    }
+
+    uint64_t hash_machine_state(const cProcessor* processor, cRam* ram, const cDisplay* display, const cTimer* delay_timer, const cTimer* sound_timer)
+    {
+        uint8_t registers[REGISTER_COUNT];
+        for (int32_t i = 0; i < REGISTER_COUNT; i++)
+        {
+            registers[i] = processor->get_register(i);
+        }
+
+        std::vector<uint8_t> ram_bytes(ram->size());
+        for (int32_t i = 0; i < ram->size(); i++)
+        {
+            ram_bytes[i] = ram->read(i);
+        }
+
+        return hash_machine_state(registers,
+                                  processor->get_register_i(),
+                                  processor->get_program_counter(),
+                                  delay_timer->get_time(),
+                                  sound_timer->get_time(),
+                                  ram_bytes.data(),
+                                  ram->size(),
+                                  display->get_rows(),
+                                  display->get_height() * display->get_words_per_row());
+    }
+
+    uint64_t hash_machine_state(const uint8_t*  registers,
+                                uint16_t        register_i,
+                                uint16_t        program_counter,
+                                uint8_t         delay_time,
+                                uint8_t         sound_time,
+                                const uint8_t*  ram,
+                                int32_t         ram_size,
+                                const uint64_t* rows,
+                                int32_t         row_word_count)
+    {
+        uint64_t hash = FNV_OFFSET_BASIS;
+
+        for (int32_t i = 0; i < REGISTER_COUNT; i++)
+        {
+            hash_byte(&hash, registers[i]);
+        }
+
+        hash_word(&hash, register_i, 2);
+        hash_word(&hash, program_counter, 2);
+        hash_byte(&hash, delay_time);
+        hash_byte(&hash, sound_time);
+
+        for (int32_t i = 0; i < ram_size; i++)
+        {
+            hash_byte(&hash, ram[i]);
+        }
+
+        for (int32_t i = 0; i < row_word_count; i++)
+        {
+            hash_word(&hash, rows[i], 8);
+        }
+
+        return hash;
+    }
+
+    sHeadlessResult run_headless(int64_t         cycle_limit,
+                                 int64_t         frame_limit,
+                                 int32_t         instructions_per_second,
+                                 bool            skip_idle_loops,
+                                 cProcessor*     processor,
+                                 cRam*           ram,
+                                 cDisplay*       display,
+                                 cKeyboard*      keyboard,
+                                 cTimer*         delay_timer,
+                                 cTimer*         sound_timer,
+                                 cInputPlayback* playback)
+    {
+        sHeadlessResult result {};
+        cScheduler      scheduler {instructions_per_second, cScheduler::ePacing::unthrottled};
+        scheduler.set_idle_skipping(skip_idle_loops);
+
+        if (playback != nullptr)
+        {
+            playback->apply_due_events(0, keyboard);
+            scheduler.set_frame_listener([&scheduler, playback, keyboard]() { playback->apply_due_events(scheduler.get_frames(), keyboard); });
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        result.executed = scheduler.run(cycle_limit, frame_limit, processor, ram, display, keyboard, delay_timer, sound_timer);
+        result.frames = scheduler.get_frames();
+        result.idle = scheduler.get_idle_cycles();
+        result.halted = scheduler.get_halted_cycles();
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        result.seconds = elapsed.count();
+        result.state_hash = hash_machine_state(processor, ram, display, delay_timer, sound_timer);
+
+        return result;
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef CHIP8_SRC_HEADLESSHPP
+#define CHIP8_SRC_HEADLESSHPP
+
+#include <cstdint>
+
+namespace chip8
+{
+    class cDisplay;
+    class cInputPlayback;
+    class cKeyboard;
+    class cProcessor;
+    class cRam;
+    class cTimer;
+
+    struct sHeadlessResult
+    {
+        int64_t  executed;   // Cycles, see cScheduler::run.
+        int64_t  frames;     // Timer ticks.
+        int64_t  idle;       // Instructions covered by idle loop skipping instead of executed.
+        int64_t  halted;     // Cycles spent waiting for a key.
+        double   seconds;    // Host time spent running.
+        uint64_t state_hash; // hash_machine_state once the run finished.
+    };
+
+    // FNV-1a over everything a ROM can observe: registers, I, program counter, ram, framebuffer and timers.
+    // Two runs of the same ROM with the same input end with the same hash.
+    uint64_t hash_machine_state(const cProcessor* processor, cRam* ram, const cDisplay* display, const cTimer* delay_timer, const cTimer* sound_timer);
+
+    // Same hash over plain state, for machines not built from the classes above. registers holds REGISTER_COUNT bytes.
+    uint64_t hash_machine_state(const uint8_t*  registers,
+                                uint16_t        register_i,
+                                uint16_t        program_counter,
+                                uint8_t         delay_time,
+                                uint8_t         sound_time,
+                                const uint8_t*  ram,
+                                int32_t         ram_size,
+                                const uint64_t* rows,
+                                int32_t         row_word_count);
+
+    // Runs until either limit is reached as fast as the host allows, with the timers ticking at 60 Hz of emulated time.
+    // Nothing is rendered and nothing is logged. The only input is the playback, if any.
+    sHeadlessResult run_headless(int64_t         cycle_limit,
+                                 int64_t         frame_limit,
+                                 int32_t         instructions_per_second,
+                                 bool            skip_idle_loops,
+                                 cProcessor*     processor,
+                                 cRam*           ram,
+                                 cDisplay*       display,
+                                 cKeyboard*      keyboard,
+                                 cTimer*         delay_timer,
+                                 cTimer*         sound_timer,
+                                 cInputPlayback* playback = nullptr);
+}
+
+#endif // CHIP8_SRC_HEADLESSHPP
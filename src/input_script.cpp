@@ -0,0 +1,129 @@
+#include "input_script.hpp"
+
+#include "keyboard.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+namespace chip8
+{
+    bool is_skipped_line(const std::string& line)
+    {
+        size_t first = line.find_first_not_of(" \t\r");
+        return first == std::string::npos || line[first] == '#';
+    }
+
+    int32_t load_input_script(const std::string& path, std::vector<sInputEvent>* events)
+    {
+        std::ifstream file {path};
+        if (!file.is_open())
+        {
+            return -1;
+        }
+
+        std::string line;
+
+        while (std::getline(file, line))
+        {
+            if (is_skipped_line(line))
+            {
+                continue;
+            }
+
+            std::istringstream fields {line};
+            int64_t            frame = 0;
+            uint32_t           key_id = 0;
+            std::string        state;
+
+            if (!(fields >> frame >> std::hex >> key_id >> state) || key_id >= KEY_COUNT || (state != "down" && state != "up"))
+            {
+                return -1;
+            }
+
+            if (frame < 0 || (!events->empty() && frame < events->back().frame))
+            {
+                return -1;
+            }
+
+            events->push_back({frame, static_cast<uint8_t>(key_id), state == "down"});
+        }
+
+        return 0;
+    }
+
+    int32_t save_input_script(const std::string& path, const std::vector<sInputEvent>& events, const std::string& header)
+    {
+        FILE* file = std::fopen(path.c_str(), "w");
+        if (file == nullptr)
+        {
+            return -1;
+        }
+
+        std::istringstream header_lines {header};
+        std::string        line;
+        while (std::getline(header_lines, line))
+        {
+            std::fprintf(file, "# %s\n", line.c_str());
+        }
+
+        for (const sInputEvent& event : events)
+        {
+            std::fprintf(file, "%" PRId64 " %X %s", event.frame, event.key_id, event.pressed ? "down" : "up");
+
+            if (event.cycle >= 0)
+            {
+                std::fprintf(file, " # cycle %" PRId64, event.cycle);
+            }
+
+            std::fprintf(file, "\n");
+        }
+
+        return std::fclose(file) == 0 ? 0 : -1;
+    }
+
+    void cInputRecorder::set_position(int64_t frame, int64_t cycle)
+    {
+        _frame = frame;
+        _cycle = cycle;
+    }
+
+    void cInputRecorder::record(uint8_t key_id, bool pressed)
+    {
+        _events.push_back({_frame, key_id, pressed, _cycle});
+    }
+
+    const std::vector<sInputEvent>& cInputRecorder::get_events() const
+    {
+        return _events;
+    }
+
+    cInputPlayback::cInputPlayback(std::vector<sInputEvent> events)
+      : _events(std::move(events))
+    {
+    }
+
+    void cInputPlayback::apply_due_events(int64_t frame, cKeyboard* keyboard)
+    {
+        for (; _next < _events.size() && _events[_next].frame <= frame; _next++)
+        {
+            const sInputEvent& event = _events[_next];
+            if (!(event.pressed ? keyboard->press_key(event.key_id) : keyboard->release_key(event.key_id)))
+            {
+                break;
+            }
+        }
+    }
+
+    bool cInputPlayback::is_finished() const
+    {
+        return _next == _events.size();
+    }
+
+    int64_t cInputPlayback::get_applied() const
+    {
+        return static_cast<int64_t>(_next);
+    }
+}
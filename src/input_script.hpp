@@ -0,0 +1,72 @@
+#ifndef CHIP8_SRC_INPUTSCRIPTHPP
+#define CHIP8_SRC_INPUTSCRIPTHPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace chip8
+{
+    class cKeyboard;
+
+    // Key change applied once the given number of frames has passed.
+    struct sInputEvent
+    {
+        int64_t frame;
+        uint8_t key_id;
+        bool    pressed;
+        int64_t cycle {-1}; // Cycle that frame ended at, when recorded. Only informative.
+    };
+
+    // True for empty lines and lines starting with #, which input scripts and farm manifests skip.
+    bool is_skipped_line(const std::string& line);
+
+    // Input script lines are "<frame> <key 0-F> <down|up>", sorted by frame. Anything after the state is ignored.
+    // Empty lines and lines starting with # are skipped. Returns -1 if the file can not be read or a line is malformed.
+    int32_t load_input_script(const std::string& path, std::vector<sInputEvent>* events);
+
+    // Writes the events in the same format, each followed by its cycle as a comment if known. The header goes first,
+    // one comment line per line of it. Returns -1 if the file can not be written.
+    int32_t save_input_script(const std::string& path, const std::vector<sInputEvent>& events, const std::string& header);
+
+    // Timeline of the key events a keyboard applied. Each is stamped with the frame that had ended when the emulation
+    // thread took it, which is exactly when cInputPlayback hands it back, so a replay sees every key change at the
+    // same instruction. Only sound while machine state moves forward, rewinding is not recorded.
+    class cInputRecorder
+    {
+      public:
+        // Called once a frame has ended, before anything polls the keyboard again.
+        void set_position(int64_t frame, int64_t cycle);
+
+        // Called by the keyboard for every event it applies.
+        void record(uint8_t key_id, bool pressed);
+
+        const std::vector<sInputEvent>& get_events() const;
+
+      private:
+        std::vector<sInputEvent> _events;
+        int64_t                  _frame {0};
+        int64_t                  _cycle {0};
+    };
+
+    // Feeds a timeline back into a keyboard. Events of frame 0 are due before the first instruction,
+    // the others once their frame has ended.
+    class cInputPlayback
+    {
+      public:
+        explicit cInputPlayback(std::vector<sInputEvent> events);
+
+        // Queues every event due by the given frame that was not queued yet. Stops at the first one the keyboard queue
+        // has no room for, which is tried again on the next call.
+        void apply_due_events(int64_t frame, cKeyboard* keyboard);
+
+        bool    is_finished() const;
+        int64_t get_applied() const;
+
+      private:
+        std::vector<sInputEvent> _events;
+        size_t                   _next {0};
+    };
+}
+
+#endif // CHIP8_SRC_INPUTSCRIPTHPP
@@ -0,0 +1,252 @@
+#include "jit.hpp"
+
+#include "ram.hpp"
+
+#include <assert.h>
+
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__unix__)
+#define CHIP8_JIT_X86_64 1
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define CHIP8_JIT_X86_64 0
+#endif
+
+namespace chip8
+{
+    namespace
+    {
+        constexpr uint8_t REGISTER_VF = 15;
+
+        // Register file is addressed relative to rdi, I through rsi. al, cl and dl are scratch.
+        class cEmitter
+        {
+          public:
+            void bytes(std::initializer_list<uint8_t> values)
+            {
+                _code.insert(_code.end(), values);
+            }
+
+            void load_al(uint8_t reg) { bytes({0x8A, 0x47, reg}); }  // mov al, [rdi+reg]
+            void store_al(uint8_t reg) { bytes({0x88, 0x47, reg}); } // mov [rdi+reg], al
+            void store_cl(uint8_t reg) { bytes({0x88, 0x4F, reg}); } // mov [rdi+reg], cl
+
+            const std::vector<uint8_t>& code() const { return _code; }
+
+          private:
+            std::vector<uint8_t> _code;
+        };
+
+        // Mirrors the interpreter handlers, including the order of the Vx and VF writes when X is F.
+        void emit_instruction(cEmitter* emitter, eOpcode type, const sInstruction& instruction)
+        {
+            uint8_t x = instruction.x;
+            uint8_t y = instruction.y;
+
+            switch (type)
+            {
+                case eOpcode::opcode_6XNN:
+                    emitter->bytes({0xC6, 0x47, x, instruction.nn}); // mov byte [rdi+x], nn
+                    break;
+                case eOpcode::opcode_7XNN:
+                    emitter->bytes({0x80, 0x47, x, instruction.nn}); // add byte [rdi+x], nn
+                    break;
+                case eOpcode::opcode_8XY0:
+                    emitter->load_al(y);
+                    emitter->store_al(x);
+                    break;
+                case eOpcode::opcode_8XY1:
+                    emitter->load_al(y);
+                    emitter->bytes({0x08, 0x47, x}); // or [rdi+x], al
+                    break;
+                case eOpcode::opcode_8XY2:
+                    emitter->load_al(y);
+                    emitter->bytes({0x20, 0x47, x}); // and [rdi+x], al
+                    break;
+                case eOpcode::opcode_8XY3:
+                    emitter->load_al(y);
+                    emitter->bytes({0x30, 0x47, x}); // xor [rdi+x], al
+                    break;
+                case eOpcode::opcode_8XY4:
+                    emitter->load_al(x);
+                    emitter->bytes({0x02, 0x47, y});  // add al, [rdi+y]
+                    emitter->bytes({0x0F, 0x92, 0xC1}); // setc cl
+                    emitter->store_al(x);
+                    emitter->store_cl(REGISTER_VF);
+                    break;
+                case eOpcode::opcode_8XY5:
+                    emitter->load_al(x);
+                    emitter->bytes({0x2A, 0x47, y});  // sub al, [rdi+y]
+                    emitter->bytes({0x0F, 0x93, 0xC1}); // setnc cl
+                    emitter->store_al(x);
+                    emitter->store_cl(REGISTER_VF);
+                    break;
+                case eOpcode::opcode_8XY6:
+                    emitter->load_al(x);
+                    emitter->bytes({0x88, 0xC1});       // mov cl, al
+                    emitter->bytes({0x80, 0xE1, 0x01}); // and cl, 1
+                    emitter->store_cl(REGISTER_VF);
+                    emitter->bytes({0xD0, 0xE8}); // shr al, 1
+                    emitter->store_al(x);
+                    break;
+                case eOpcode::opcode_8XY7:
+                    emitter->load_al(y);
+                    emitter->bytes({0x2A, 0x47, x});  // sub al, [rdi+x]
+                    emitter->bytes({0x0F, 0x93, 0xC1}); // setnc cl
+                    emitter->store_al(x);
+                    emitter->store_cl(REGISTER_VF);
+                    break;
+                case eOpcode::opcode_8XYE:
+                    emitter->load_al(x);
+                    emitter->bytes({0x88, 0xC1});       // mov cl, al
+                    emitter->bytes({0xC0, 0xE9, 0x07}); // shr cl, 7
+                    emitter->store_cl(REGISTER_VF);
+                    emitter->bytes({0xD0, 0xE0}); // shl al, 1
+                    emitter->store_al(x);
+                    break;
+                case eOpcode::opcode_ANNN:
+                {
+                    uint8_t low = instruction.nnn & 0xFF;
+                    uint8_t high = instruction.nnn >> 8;
+                    emitter->bytes({0x66, 0xC7, 0x06, low, high}); // mov word [rsi], nnn
+                }
+                break;
+                case eOpcode::opcode_FX1E:
+                {
+                    // I += Vx, wrapping past the end of ram like the interpreter does.
+                    constexpr uint32_t wrap = RAM_SIZE + 1;
+                    emitter->bytes({0x0F, 0xB6, 0x47, x});  // movzx eax, byte [rdi+x]
+                    emitter->bytes({0x0F, 0xB7, 0x0E});     // movzx ecx, word [rsi]
+                    emitter->bytes({0x01, 0xC1});           // add ecx, eax
+                    emitter->bytes({0x89, 0xCA});           // mov edx, ecx
+                    emitter->bytes({0x81, 0xEA, wrap & 0xFF, (wrap >> 8) & 0xFF, 0x00, 0x00});       // sub edx, RAM_SIZE + 1
+                    emitter->bytes({0x81, 0xF9, RAM_SIZE & 0xFF, (RAM_SIZE >> 8) & 0xFF, 0x00, 0x00}); // cmp ecx, RAM_SIZE
+                    emitter->bytes({0x0F, 0x47, 0xCA});     // cmova ecx, edx
+                    emitter->bytes({0x66, 0x89, 0x0E});     // mov [rsi], cx
+                }
+                break;
+                default:
+                    assert(false && "Instruction can not be compiled");
+                    break;
+            }
+        }
+    }
+
+    cJitCompiler::cJitCompiler()
+    {
+#if CHIP8_JIT_X86_64
+        void* memory = mmap(nullptr, JIT_CODE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory != MAP_FAILED)
+        {
+            _code = static_cast<uint8_t*>(memory);
+            _page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        }
+#endif
+    }
+
+    cJitCompiler::~cJitCompiler()
+    {
+#if CHIP8_JIT_X86_64
+        if (_code != nullptr)
+        {
+            munmap(_code, JIT_CODE_SIZE);
+        }
+#endif
+    }
+
+    bool cJitCompiler::is_available() const
+    {
+        return _code != nullptr;
+    }
+
+    bool cJitCompiler::can_compile(eOpcode type)
+    {
+        switch (type)
+        {
+            case eOpcode::opcode_6XNN:
+            case eOpcode::opcode_7XNN:
+            case eOpcode::opcode_8XY0:
+            case eOpcode::opcode_8XY1:
+            case eOpcode::opcode_8XY2:
+            case eOpcode::opcode_8XY3:
+            case eOpcode::opcode_8XY4:
+            case eOpcode::opcode_8XY5:
+            case eOpcode::opcode_8XY6:
+            case eOpcode::opcode_8XY7:
+            case eOpcode::opcode_8XYE:
+            case eOpcode::opcode_ANNN:
+            case eOpcode::opcode_FX1E:
+                return CHIP8_JIT_X86_64 != 0;
+            default:
+                return false;
+        }
+    }
+
+    cJitCompiler::tNativeCode cJitCompiler::compile(const sInstruction* instructions, int32_t count)
+    {
+        if (!is_available())
+        {
+            return nullptr;
+        }
+
+        cEmitter emitter;
+        for (int32_t i = 0; i < count; i++)
+        {
+            emit_instruction(&emitter, classify_opcode(instructions[i].opcode), instructions[i]);
+        }
+        emitter.bytes({0xC3}); // ret
+
+        const std::vector<uint8_t>& code = emitter.code();
+        if (_used + code.size() > JIT_CODE_SIZE)
+        {
+            return nullptr;
+        }
+
+        // The first page may hold earlier code. Nothing runs it while it is writable, compiling happens between runs.
+        size_t begin = _used;
+        size_t end = _used + code.size();
+        if (!protect(begin, end, false))
+        {
+            return nullptr;
+        }
+
+        uint8_t* destination = _code + begin;
+        std::memcpy(destination, code.data(), code.size());
+        _used = end;
+
+        if (!protect(begin, end, true))
+        {
+            return nullptr;
+        }
+
+        return reinterpret_cast<tNativeCode>(destination);
+    }
+
+    void cJitCompiler::reset()
+    {
+        // Code handed out before can no longer be run by mistake.
+        protect(0U, _used, false);
+        _used = 0U;
+    }
+
+    bool cJitCompiler::protect(size_t begin, size_t end, [[maybe_unused]] bool executable)
+    {
+        if (_code == nullptr || begin == end)
+        {
+            return true;
+        }
+
+        size_t first_page = begin / _page_size * _page_size;
+        size_t last_page = (end + _page_size - 1) / _page_size * _page_size;
+
+#if CHIP8_JIT_X86_64
+        int protection = executable ? PROT_READ | PROT_EXEC : PROT_READ | PROT_WRITE;
+        return mprotect(_code + first_page, last_page - first_page, protection) == 0;
+#else
+        return false;
+#endif
+    }
+}
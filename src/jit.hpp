@@ -0,0 +1,48 @@
+#ifndef CHIP8_SRC_JITHPP
+#define CHIP8_SRC_JITHPP
+
+#include "opcode.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace chip8
+{
+    constexpr size_t JIT_CODE_SIZE = 1024 * 1024;
+
+    // Compiles straight-line runs of register only instructions into native x86-64 code.
+    // Anything touching ram, timers, the display, the keyboard or the program counter is left to the interpreter.
+    // The code buffer is never writable and executable at once: pages are made writable while code is copied into them
+    // and executable again once it is in place.
+    class cJitCompiler
+    {
+      public:
+        // Compiled runs take the register file and the I register. Both must stay at the same address for the code's lifetime.
+        using tNativeCode = void (*)(uint8_t* registers, uint16_t* register_i);
+
+        cJitCompiler();
+        ~cJitCompiler();
+
+        cJitCompiler(const cJitCompiler&) = delete;
+        cJitCompiler& operator=(const cJitCompiler&) = delete;
+
+        // False when the host is not x86-64 or executable memory could not be mapped.
+        bool is_available() const;
+
+        static bool can_compile(eOpcode type);
+
+        // Returns nullptr when the code buffer is full. Call reset() once nothing uses previously returned code.
+        tNativeCode compile(const sInstruction* instructions, int32_t count);
+        void        reset();
+
+      private:
+        // Makes the pages covering the given range of the code buffer either executable or writable.
+        bool protect(size_t begin, size_t end, bool executable);
+
+        uint8_t* _code {nullptr};
+        size_t   _used {0U};
+        size_t   _page_size {4096U};
+    };
+}
+
+#endif // CHIP8_SRC_JITHPP
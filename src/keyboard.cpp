@@ -1,18 +1,85 @@
 #include "keyboard.hpp"
+#include "input_script.hpp"
+#include "machine_state.hpp"
+
+#include <assert.h>
 
 namespace chip8
 {
-    bool cKeyboard::is_key_pressed(uint8_t key_id)
+    cKeyboard::cKeyboard(sMachineState* state)
+      : _state(state)
+    {
+    }
+
+    bool cKeyboard::is_key_pressed(uint8_t key_id) const
     {
-        // TODO: Proper keyboard input.
-        return false;
+        // Only the lowest nibble names a key.
+        return (_state->key_state >> (key_id & 0xF)) & 0b1;
     }
 
     int8_t cKeyboard::await_key_press()
     {
-        // TODO: Proper keyboard input.
-        // TODO: Return -1 when key not pressed. failure.
-        // TODO: Assert that return value is <=0xF.
-        return -1;
+        int8_t pressed_key = _state->pending_press;
+        _state->pending_press = -1;
+
+        assert(pressed_key <= 0xF);
+        return pressed_key;
+    }
+
+    bool cKeyboard::press_key(uint8_t key_id)
+    {
+        assert(key_id < KEY_COUNT);
+        return _events.push(key_id | KEY_EVENT_PRESSED);
+    }
+
+    bool cKeyboard::release_key(uint8_t key_id)
+    {
+        assert(key_id < KEY_COUNT);
+        return _events.push(key_id);
+    }
+
+    void cKeyboard::poll_events()
+    {
+        if (!_event_polling)
+        {
+            return;
+        }
+
+        uint8_t event;
+        while (_events.pop(&event))
+        {
+            uint8_t key_id = event & 0xF;
+
+            if (_recorder != nullptr)
+            {
+                _recorder->record(key_id, event & KEY_EVENT_PRESSED);
+            }
+
+            if (event & KEY_EVENT_PRESSED)
+            {
+                // A press and release between two polls still counts as a press for FX0A.
+                _state->key_state |= 1U << key_id;
+                _state->pending_press = static_cast<int8_t>(key_id);
+            }
+            else
+            {
+                _state->key_state &= ~(1U << key_id);
+            }
+        }
+    }
+
+    void cKeyboard::set_event_polling(bool enabled)
+    {
+        _event_polling = enabled;
+    }
+
+    void cKeyboard::set_event_recorder(cInputRecorder* recorder)
+    {
+        _recorder = recorder;
+    }
+
+    uint16_t cKeyboard::get_key_state() const
+    {
+        return _state->key_state;
     }
 }
@@ -1,15 +1,54 @@
 #ifndef CHIP8_SRC_KEYBOARDHPP
 #define CHIP8_SRC_KEYBOARDHPP
 
+#include "spsc_ring.hpp"
+
 #include <cstdint>
 
 namespace chip8
 {
+    constexpr int32_t KEY_COUNT = 16;
+    constexpr size_t  KEY_EVENT_CAPACITY = 64;
+
+    class cInputRecorder;
+    struct sMachineState;
+
+    // Key events are produced by one host thread and consumed by the emulation thread, which folds them into a
+    // key state bitmask at the start of every run. Instructions only ever test bits of that mask.
     class cKeyboard
     {
       public:
-        bool   is_key_pressed(uint8_t key_id);
-        int8_t await_key_press();
+        // View over the key state and pending press of the given state. Queued events are not part of it.
+        explicit cKeyboard(sMachineState* state);
+
+        bool   is_key_pressed(uint8_t key_id) const;
+        int8_t await_key_press(); // Takes the last press not yet awaited. -1 if there is none.
+
+        // Producer side, from a single thread. False if the event was dropped because the queue is full.
+        bool press_key(uint8_t key_id);
+        bool release_key(uint8_t key_id);
+
+        // Consumer side. Applies every queued event.
+        void poll_events();
+
+        // While disabled, poll_events leaves the queue alone. For runs that are rolled back afterwards, which would
+        // otherwise lose the events they took.
+        void set_event_polling(bool enabled);
+
+        // Every event poll_events applies is passed on to the recorder, null for none.
+        void set_event_recorder(cInputRecorder* recorder);
+
+        uint16_t get_key_state() const;
+
+      private:
+        // Key id in the low nibble, KEY_EVENT_PRESSED set for presses.
+        static constexpr uint8_t KEY_EVENT_PRESSED = 0x80;
+
+        cSpscRing<uint8_t, KEY_EVENT_CAPACITY> _events;
+
+        sMachineState*  _state;
+        bool            _event_polling {true};
+        cInputRecorder* _recorder {nullptr};
     };
 }
 #endif // CHIP8_SRC_KEYBOARDHPP
@@ -0,0 +1,873 @@
+#include "lockstep.hpp"
+
+#include "headless.hpp"
+#include "keyboard.hpp"
+#include "log.hpp"
+#include "machine_state.hpp"
+#include "opcode.hpp"
+#include "processor.hpp"
+#include "ram.hpp"
+#include "scheduler.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <cstdlib>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+
+namespace chip8
+{
+    namespace
+    {
+        // Raw views of the batch's arrays for the kernels. Entry [index * stride + instance].
+        struct sLaneArrays
+        {
+            uint8_t*  registers;
+            uint8_t*  ram;
+            uint16_t* register_i;
+            uint16_t* program_counter;
+            uint8_t*  delay_time;
+            uint8_t*  sound_time;
+            uint8_t*  pending;
+            uint8_t*  group;
+            int32_t   stride;
+        };
+
+        // Instructions the group kernels run. They only touch registers, I, the program counter and timers.
+        bool is_group_opcode(eOpcode type)
+        {
+            switch (type)
+            {
+                case eOpcode::opcode_1NNN:
+                case eOpcode::opcode_3XNN:
+                case eOpcode::opcode_4XNN:
+                case eOpcode::opcode_5XY0:
+                case eOpcode::opcode_6XNN:
+                case eOpcode::opcode_7XNN:
+                case eOpcode::opcode_8XY0:
+                case eOpcode::opcode_8XY1:
+                case eOpcode::opcode_8XY2:
+                case eOpcode::opcode_8XY3:
+                case eOpcode::opcode_8XY4:
+                case eOpcode::opcode_8XY5:
+                case eOpcode::opcode_8XY6:
+                case eOpcode::opcode_8XY7:
+                case eOpcode::opcode_8XYE:
+                case eOpcode::opcode_9XY0:
+                case eOpcode::opcode_ANNN:
+                case eOpcode::opcode_FX07:
+                case eOpcode::opcode_FX15:
+                case eOpcode::opcode_FX18:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CHIP8_SIMD_LOCKSTEP 1
+
+        // Instances still pending whose program counter and opcode match. Writes the group mask, returns its size.
+        __attribute__((target("avx2"))) int32_t build_group_avx2(const sLaneArrays& lanes, uint16_t program_counter, uint16_t opcode)
+        {
+            const uint8_t* opcode_high_row = lanes.ram + program_counter * lanes.stride;
+            const uint8_t* opcode_low_row = opcode_high_row + lanes.stride;
+
+            __m256i wanted_pc = _mm256_set1_epi16(static_cast<int16_t>(program_counter));
+            __m256i wanted_high = _mm256_set1_epi8(static_cast<char>(opcode >> 8));
+            __m256i wanted_low = _mm256_set1_epi8(static_cast<char>(opcode & 0xFF));
+            int32_t size = 0;
+
+            for (int32_t o = 0; o < lanes.stride; o += LOCKSTEP_LANE_BLOCK)
+            {
+                __m256i pc_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes.program_counter + o));
+                __m256i pc_second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes.program_counter + o + 16));
+
+                // Packing works per 128 bit half, the permute puts the instances back in order.
+                __m256i same_pc = _mm256_packs_epi16(_mm256_cmpeq_epi16(pc_first, wanted_pc), _mm256_cmpeq_epi16(pc_second, wanted_pc));
+                same_pc = _mm256_permute4x64_epi64(same_pc, 0xD8);
+
+                __m256i same_high = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(opcode_high_row + o)), wanted_high);
+                __m256i same_low = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(opcode_low_row + o)), wanted_low);
+                __m256i pending = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes.pending + o));
+
+                __m256i group = _mm256_and_si256(_mm256_and_si256(same_pc, pending), _mm256_and_si256(same_high, same_low));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes.group + o), group);
+                size += __builtin_popcount(static_cast<uint32_t>(_mm256_movemask_epi8(group)));
+            }
+
+            return size;
+        }
+
+        __attribute__((target("avx2"))) void store_masked(uint8_t* destination, __m256i value, __m256i mask)
+        {
+            __m256i old_value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(destination));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination), _mm256_blendv_epi8(old_value, value, mask));
+        }
+
+        // Sets the 16 bit entries of 32 instances where the byte mask is set.
+        __attribute__((target("avx2"))) void store_masked_words(uint16_t* destination, __m256i first_value, __m256i second_value, __m256i mask)
+        {
+            __m256i first_mask = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(mask));
+            __m256i second_mask = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(mask, 1));
+            store_masked(reinterpret_cast<uint8_t*>(destination), first_value, first_mask);
+            store_masked(reinterpret_cast<uint8_t*>(destination + 16), second_value, second_mask);
+        }
+
+        // Runs one instruction for every instance of the group. Follows cProcessor's handlers, including the order
+        // Vx and VF are written in when X is F.
+        __attribute__((target("avx2"))) void execute_group_avx2(const sLaneArrays& lanes, const sInstruction& instruction, eOpcode type, uint16_t next_program_counter)
+        {
+            uint8_t* vx_row = lanes.registers + instruction.x * lanes.stride;
+            uint8_t* vy_row = lanes.registers + instruction.y * lanes.stride;
+            uint8_t* vf_row = lanes.registers + 0xF * lanes.stride;
+
+            __m256i nn = _mm256_set1_epi8(static_cast<char>(instruction.nn));
+            __m256i one = _mm256_set1_epi8(1);
+            __m256i all_set = _mm256_set1_epi8(-1);
+
+            for (int32_t o = 0; o < lanes.stride; o += LOCKSTEP_LANE_BLOCK)
+            {
+                __m256i mask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes.group + o));
+                if (_mm256_testz_si256(mask, mask))
+                {
+                    continue;
+                }
+
+                __m256i vx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(vx_row + o));
+                __m256i vy = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(vy_row + o));
+                __m256i skip = _mm256_setzero_si256(); // Instances that skip the next instruction.
+
+                switch (type)
+                {
+                    case eOpcode::opcode_3XNN:
+                    {
+                        skip = _mm256_cmpeq_epi8(vx, nn);
+                    }
+                    break;
+                    case eOpcode::opcode_4XNN:
+                    {
+                        skip = _mm256_xor_si256(_mm256_cmpeq_epi8(vx, nn), all_set);
+                    }
+                    break;
+                    case eOpcode::opcode_5XY0:
+                    {
+                        skip = _mm256_cmpeq_epi8(vx, vy);
+                    }
+                    break;
+                    case eOpcode::opcode_9XY0:
+                    {
+                        skip = _mm256_xor_si256(_mm256_cmpeq_epi8(vx, vy), all_set);
+                    }
+                    break;
+                    case eOpcode::opcode_6XNN:
+                    {
+                        store_masked(vx_row + o, nn, mask);
+                    }
+                    break;
+                    case eOpcode::opcode_7XNN:
+                    {
+                        store_masked(vx_row + o, _mm256_add_epi8(vx, nn), mask);
+                    }
+                    break;
+                    case eOpcode::opcode_8XY0:
+                    {
+                        store_masked(vx_row + o, vy, mask);
+                    }
+                    break;
+                    case eOpcode::opcode_8XY1:
+                    {
+                        store_masked(vx_row + o, _mm256_or_si256(vx, vy), mask);
+                    }
+                    break;
+                    case eOpcode::opcode_8XY2:
+                    {
+                        store_masked(vx_row + o, _mm256_and_si256(vx, vy), mask);
+                    }
+                    break;
+                    case eOpcode::opcode_8XY3:
+                    {
+                        store_masked(vx_row + o, _mm256_xor_si256(vx, vy), mask);
+                    }
+                    break;
+                    case eOpcode::opcode_8XY4:
+                    {
+                        // The wrapped and the saturated sum only differ on overflow.
+                        __m256i sum = _mm256_add_epi8(vx, vy);
+                        __m256i no_carry = _mm256_cmpeq_epi8(_mm256_adds_epu8(vx, vy), sum);
+                        store_masked(vx_row + o, sum, mask);
+                        store_masked(vf_row + o, _mm256_andnot_si256(no_carry, one), mask);
+                    }
+                    break;
+                    case eOpcode::opcode_8XY5:
+                    {
+                        __m256i no_borrow = _mm256_cmpeq_epi8(_mm256_max_epu8(vx, vy), vx);
+                        store_masked(vx_row + o, _mm256_sub_epi8(vx, vy), mask);
+                        store_masked(vf_row + o, _mm256_and_si256(no_borrow, one), mask);
+                    }
+                    break;
+                    case eOpcode::opcode_8XY6:
+                    {
+                        store_masked(vf_row + o, _mm256_and_si256(vx, one), mask);
+                        store_masked(vx_row + o, _mm256_and_si256(_mm256_srli_epi16(vx, 1), _mm256_set1_epi8(0x7F)), mask);
+                    }
+                    break;
+                    case eOpcode::opcode_8XY7:
+                    {
+                        __m256i no_borrow = _mm256_cmpeq_epi8(_mm256_max_epu8(vy, vx), vy);
+                        store_masked(vx_row + o, _mm256_sub_epi8(vy, vx), mask);
+                        store_masked(vf_row + o, _mm256_and_si256(no_borrow, one), mask);
+                    }
+                    break;
+                    case eOpcode::opcode_8XYE:
+                    {
+                        store_masked(vf_row + o, _mm256_and_si256(_mm256_srli_epi16(vx, 7), one), mask);
+                        store_masked(vx_row + o, _mm256_add_epi8(vx, vx), mask);
+                    }
+                    break;
+                    case eOpcode::opcode_ANNN:
+                    {
+                        __m256i nnn = _mm256_set1_epi16(static_cast<int16_t>(instruction.nnn));
+                        store_masked_words(lanes.register_i + o, nnn, nnn, mask);
+                    }
+                    break;
+                    case eOpcode::opcode_FX07:
+                    {
+                        store_masked(vx_row + o, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes.delay_time + o)), mask);
+                    }
+                    break;
+                    case eOpcode::opcode_FX15:
+                    {
+                        store_masked(lanes.delay_time + o, vx, mask);
+                    }
+                    break;
+                    case eOpcode::opcode_FX18:
+                    {
+                        store_masked(lanes.sound_time + o, vx, mask);
+                    }
+                    break;
+                    default:
+                    {
+                        // 1NNN only moves the program counter.
+                    }
+                    break;
+                }
+
+                // Skipping instances move two bytes further.
+                __m256i next = _mm256_set1_epi16(static_cast<int16_t>(next_program_counter));
+                __m256i two = _mm256_set1_epi16(2);
+                __m256i first_skip = _mm256_and_si256(_mm256_cvtepi8_epi16(_mm256_castsi256_si128(skip)), two);
+                __m256i second_skip = _mm256_and_si256(_mm256_cvtepi8_epi16(_mm256_extracti128_si256(skip, 1)), two);
+                store_masked_words(lanes.program_counter + o, _mm256_add_epi16(next, first_skip), _mm256_add_epi16(next, second_skip), mask);
+            }
+        }
+
+        __attribute__((target("avx2"))) void tick_timers_avx2(const sLaneArrays& lanes)
+        {
+            __m256i one = _mm256_set1_epi8(1);
+
+            for (int32_t o = 0; o < lanes.stride; o += LOCKSTEP_LANE_BLOCK)
+            {
+                __m256i delay = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes.delay_time + o));
+                __m256i sound = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes.sound_time + o));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes.delay_time + o), _mm256_subs_epu8(delay, one));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes.sound_time + o), _mm256_subs_epu8(sound, one));
+            }
+        }
+#else
+#define CHIP8_SIMD_LOCKSTEP 0
+#endif
+    }
+
+    cLockstepBatch::cLockstepBatch(int32_t instance_count, int32_t instructions_per_second, int32_t stack_depth)
+      : _instance_count(instance_count)
+      , _instructions_per_second(instructions_per_second)
+      , _stack_depth(stack_depth)
+    {
+        assert(instance_count > 0 && instructions_per_second > 0);
+        assert(stack_depth > 0 && stack_depth <= MAX_STACK_DEPTH);
+
+        _stride = (instance_count + LOCKSTEP_LANE_BLOCK - 1) / LOCKSTEP_LANE_BLOCK * LOCKSTEP_LANE_BLOCK;
+
+        _registers.assign(REGISTER_COUNT * _stride, 0U);
+        _ram.assign(RAM_SIZE * _stride, 0U);
+        _register_i.assign(_stride, 0U);
+        _program_counter.assign(_stride, PROGRAM_START_LOCATION);
+        _delay_time.assign(_stride, 0U);
+        _sound_time.assign(_stride, 0U);
+
+        _stacks.resize(instance_count);
+        _stack_pointers.assign(instance_count, 0);
+        _displays.resize(instance_count);
+        for (std::unique_ptr<cDisplay>& display : _displays)
+        {
+            display = std::make_unique<cDisplay>(DISPLAY_HEIGHT, DISPLAY_WIDTH);
+        }
+
+        _random.assign(instance_count, cRandom {DEFAULT_RANDOM_SEED});
+        _key_state.assign(instance_count, 0U);
+        _pending_press.assign(instance_count, -1);
+        _waiting_for_key.assign(instance_count, 0U);
+        _key_register.assign(instance_count, 0U);
+
+        _pending.assign(_stride, 0U);
+        _group.assign(_stride, 0U);
+
+#if CHIP8_SIMD_LOCKSTEP
+        _vector_kernels = __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    int32_t cLockstepBatch::load_rom(const uint8_t* data, int32_t size)
+    {
+        // A scratch cRam lays out the program and the font exactly like a single machine.
+        sMachineState image_state;
+        cRam          image {&image_state, PROGRAM_START_LOCATION};
+        if (image.load_rom(data, size) != 0)
+        {
+            return -1;
+        }
+
+        for (int32_t address = 0; address < RAM_SIZE; address++)
+        {
+            uint8_t  value = image.read(address);
+            uint8_t* row = &_ram[address * _stride];
+            std::fill(row, row + _stride, value);
+        }
+
+        return 0;
+    }
+
+    void cLockstepBatch::set_random_seed(int32_t instance, uint64_t seed)
+    {
+        _random[instance].set_seed(seed);
+    }
+
+    void cLockstepBatch::press_key(int32_t instance, uint8_t key_id)
+    {
+        assert(key_id < KEY_COUNT);
+        _key_state[instance] |= 1U << key_id;
+        _pending_press[instance] = static_cast<int8_t>(key_id);
+    }
+
+    void cLockstepBatch::release_key(int32_t instance, uint8_t key_id)
+    {
+        assert(key_id < KEY_COUNT);
+        _key_state[instance] &= ~(1U << key_id);
+    }
+
+    int64_t cLockstepBatch::run(int64_t cycles)
+    {
+        // Same tick accounting as cScheduler, so the timers line up with a single machine's.
+        for (int64_t cycle = 0; cycle < cycles; cycle++)
+        {
+            step();
+
+            _tick_accumulator += TIMER_FREQUENCY;
+            while (_tick_accumulator >= _instructions_per_second)
+            {
+                _tick_accumulator -= _instructions_per_second;
+                tick_timers();
+                _frames++;
+            }
+        }
+
+        return cycles;
+    }
+
+    bool cLockstepBatch::set_vector_kernels(bool enabled)
+    {
+#if CHIP8_SIMD_LOCKSTEP
+        if (enabled && !__builtin_cpu_supports("avx2"))
+        {
+            return false;
+        }
+
+        _vector_kernels = enabled;
+        return true;
+#else
+        return !enabled;
+#endif
+    }
+
+    bool cLockstepBatch::get_vector_kernels() const
+    {
+        return _vector_kernels;
+    }
+
+    int32_t cLockstepBatch::get_instance_count() const
+    {
+        return _instance_count;
+    }
+
+    uint64_t cLockstepBatch::hash_instance(int32_t instance) const
+    {
+        uint8_t registers[REGISTER_COUNT];
+        for (int32_t i = 0; i < REGISTER_COUNT; i++)
+        {
+            registers[i] = _registers[i * _stride + instance];
+        }
+
+        std::vector<uint8_t> ram(RAM_SIZE);
+        for (int32_t address = 0; address < RAM_SIZE; address++)
+        {
+            ram[address] = _ram[address * _stride + instance];
+        }
+
+        return hash_machine_state(registers,
+                                  _register_i[instance],
+                                  _program_counter[instance],
+                                  _delay_time[instance],
+                                  _sound_time[instance],
+                                  ram.data(),
+                                  RAM_SIZE,
+                                  _displays[instance]->get_rows(),
+                                  DISPLAY_HEIGHT * DISPLAY_WORDS_PER_ROW);
+    }
+
+    uint8_t cLockstepBatch::get_register(int32_t instance, int32_t index) const
+    {
+        return _registers[index * _stride + instance];
+    }
+
+    uint16_t cLockstepBatch::get_register_i(int32_t instance) const
+    {
+        return _register_i[instance];
+    }
+
+    uint16_t cLockstepBatch::get_program_counter(int32_t instance) const
+    {
+        return _program_counter[instance];
+    }
+
+    const cDisplay& cLockstepBatch::get_display(int32_t instance) const
+    {
+        return *_displays[instance];
+    }
+
+    int64_t cLockstepBatch::get_executed() const
+    {
+        return _executed;
+    }
+
+    int64_t cLockstepBatch::get_vector_executed() const
+    {
+        return _vector_executed;
+    }
+
+    int64_t cLockstepBatch::get_halted_cycles() const
+    {
+        return _halted_cycles;
+    }
+
+    int64_t cLockstepBatch::get_stack_faults() const
+    {
+        return _stack_faults;
+    }
+
+    int64_t cLockstepBatch::get_frames() const
+    {
+        return _frames;
+    }
+
+    void cLockstepBatch::step()
+    {
+        // Every instance not halted on FX0A runs exactly one instruction.
+        for (int32_t instance = 0; instance < _instance_count; instance++)
+        {
+            if (_waiting_for_key[instance] && _pending_press[instance] != -1)
+            {
+                reg(_key_register[instance], instance) = static_cast<uint8_t>(_pending_press[instance]);
+                _pending_press[instance] = -1;
+                _waiting_for_key[instance] = 0U;
+            }
+
+            _pending[instance] = _waiting_for_key[instance] ? 0x00 : 0xFF;
+            _halted_cycles += _waiting_for_key[instance];
+        }
+
+        int32_t leader = 0;
+
+        for (int32_t group = 0; group < MAX_LOCKSTEP_GROUPS && _vector_kernels; group++)
+        {
+            while (leader < _instance_count && !_pending[leader])
+            {
+                leader++;
+            }
+
+            if (leader == _instance_count)
+            {
+                return;
+            }
+
+            uint16_t program_counter = _program_counter[leader];
+            uint16_t opcode = (ram_byte(program_counter, leader) << 8) | ram_byte(program_counter + 1, leader);
+            execute_group(program_counter, opcode);
+        }
+
+        // Whatever did not fit a group.
+        for (int32_t instance = leader; instance < _instance_count; instance++)
+        {
+            if (_pending[instance])
+            {
+                execute_instance(instance);
+            }
+        }
+    }
+
+    int32_t cLockstepBatch::build_group([[maybe_unused]] uint16_t program_counter, [[maybe_unused]] uint16_t opcode)
+    {
+        // step() only forms groups with the vector kernels on.
+        assert(_vector_kernels);
+
+#if CHIP8_SIMD_LOCKSTEP
+        sLaneArrays lanes {_registers.data(),
+                           _ram.data(),
+                           _register_i.data(),
+                           _program_counter.data(),
+                           _delay_time.data(),
+                           _sound_time.data(),
+                           _pending.data(),
+                           _group.data(),
+                           _stride};
+        return build_group_avx2(lanes, program_counter, opcode);
+#else
+        return 0;
+#endif
+    }
+
+    void cLockstepBatch::execute_group(uint16_t program_counter, uint16_t opcode)
+    {
+        assert(program_counter < RAM_SIZE - 1);
+
+        int32_t      size = build_group(program_counter, opcode);
+        sInstruction instruction = decode_instruction(opcode);
+        eOpcode      type = classify_opcode(opcode);
+
+#if CHIP8_SIMD_LOCKSTEP
+        if (_vector_kernels && size >= MIN_LOCKSTEP_GROUP && is_group_opcode(type))
+        {
+            uint16_t next_program_counter = type == eOpcode::opcode_1NNN ? instruction.nnn : program_counter + 2;
+
+            sLaneArrays lanes {_registers.data(),
+                               _ram.data(),
+                               _register_i.data(),
+                               _program_counter.data(),
+                               _delay_time.data(),
+                               _sound_time.data(),
+                               _pending.data(),
+                               _group.data(),
+                               _stride};
+            execute_group_avx2(lanes, instruction, type, next_program_counter);
+
+            for (int32_t instance = 0; instance < _instance_count; instance++)
+            {
+                _pending[instance] &= ~_group[instance];
+            }
+
+            _executed += size;
+            _vector_executed += size;
+            return;
+        }
+#endif
+
+        // Too small or not a register instruction, the group is peeled off one by one.
+        for (int32_t instance = 0; instance < _instance_count; instance++)
+        {
+            if (_group[instance])
+            {
+                execute_instance(instance);
+            }
+        }
+    }
+
+    void cLockstepBatch::execute_instance(int32_t instance)
+    {
+        // Mirrors cProcessor's handlers, quirks included, so the two always agree.
+        uint16_t&    program_counter = _program_counter[instance];
+        uint16_t&    register_i = _register_i[instance];
+        uint8_t&     vf = reg(0xF, instance);
+        uint16_t     opcode = (ram_byte(program_counter, instance) << 8) | ram_byte(program_counter + 1, instance);
+        sInstruction instruction = decode_instruction(opcode);
+        uint8_t&     vx = reg(instruction.x, instance);
+        uint8_t      vy = reg(instruction.y, instance);
+
+        _pending[instance] = 0x00;
+        _executed++;
+        program_counter += 2;
+
+        switch (classify_opcode(opcode))
+        {
+            case eOpcode::opcode_0E00:
+            {
+                _displays[instance]->clear_pixels();
+            }
+            break;
+            case eOpcode::opcode_00EE:
+            {
+                int32_t& stack_pointer = _stack_pointers[instance];
+                if (stack_pointer == 0)
+                {
+                    _stack_faults++;
+                    break;
+                }
+
+                program_counter = _stacks[instance][--stack_pointer];
+            }
+            break;
+            case eOpcode::opcode_1NNN:
+            {
+                program_counter = instruction.nnn;
+            }
+            break;
+            case eOpcode::opcode_2NNN:
+            {
+                int32_t& stack_pointer = _stack_pointers[instance];
+                if (stack_pointer == _stack_depth)
+                {
+                    _stack_faults++;
+                }
+                else
+                {
+                    _stacks[instance][stack_pointer++] = program_counter;
+                }
+
+                program_counter = instruction.nnn;
+            }
+            break;
+            case eOpcode::opcode_3XNN:
+            {
+                program_counter += vx == instruction.nn ? 2U : 0U;
+            }
+            break;
+            case eOpcode::opcode_4XNN:
+            {
+                program_counter += vx != instruction.nn ? 2U : 0U;
+            }
+            break;
+            case eOpcode::opcode_5XY0:
+            {
+                program_counter += vx == vy ? 2U : 0U;
+            }
+            break;
+            case eOpcode::opcode_6XNN:
+            {
+                vx = instruction.nn;
+            }
+            break;
+            case eOpcode::opcode_7XNN:
+            {
+                vx += instruction.nn;
+            }
+            break;
+            case eOpcode::opcode_8XY0:
+            {
+                vx = vy;
+            }
+            break;
+            case eOpcode::opcode_8XY1:
+            {
+                vx |= vy;
+            }
+            break;
+            case eOpcode::opcode_8XY2:
+            {
+                vx &= vy;
+            }
+            break;
+            case eOpcode::opcode_8XY3:
+            {
+                vx ^= vy;
+            }
+            break;
+            case eOpcode::opcode_8XY4:
+            {
+                uint8_t old_vx = vx;
+                vx = old_vx + vy;
+                vf = vx < old_vx ? 1 : 0;
+            }
+            break;
+            case eOpcode::opcode_8XY5:
+            {
+                uint8_t old_vx = vx;
+                vx = old_vx - vy;
+                vf = old_vx >= vy ? 1 : 0;
+            }
+            break;
+            case eOpcode::opcode_8XY6:
+            {
+                uint8_t old_vx = vx;
+                vf = old_vx & 0x01;
+                vx = old_vx >> 1;
+            }
+            break;
+            case eOpcode::opcode_8XY7:
+            {
+                uint8_t old_vx = vx;
+                vx = vy - old_vx;
+                vf = vy >= old_vx ? 1 : 0;
+            }
+            break;
+            case eOpcode::opcode_8XYE:
+            {
+                uint8_t old_vx = vx;
+                vf = (old_vx & 0x80) >> 7;
+                vx = old_vx << 1;
+            }
+            break;
+            case eOpcode::opcode_9XY0:
+            {
+                program_counter += vx != vy ? 2U : 0U;
+            }
+            break;
+            case eOpcode::opcode_ANNN:
+            {
+                register_i = instruction.nnn;
+            }
+            break;
+            case eOpcode::opcode_BNNN:
+            {
+                program_counter = static_cast<uint16_t>(reg(0, instance)) + instruction.nnn;
+            }
+            break;
+            case eOpcode::opcode_CXNN:
+            {
+                vx = _random[instance].next_byte() & instruction.nn;
+            }
+            break;
+            case eOpcode::opcode_DXYN:
+            {
+                // Rows 0 to N, both included.
+                int32_t row_count = instruction.n + 1;
+                uint8_t sprite_rows[MAX_SPRITE_HEIGHT];
+                for (int32_t i = 0; i < row_count; i++)
+                {
+                    sprite_rows[i] = ram_byte(register_i + i, instance);
+                }
+
+                uint8_t x = vx;
+                vf = _displays[instance]->draw_sprite(x, vy, sprite_rows, row_count) ? 1 : 0;
+            }
+            break;
+            case eOpcode::opcode_EX9E:
+            {
+                program_counter += (_key_state[instance] >> (vx & 0xF)) & 0b1 ? 2U : 0U;
+            }
+            break;
+            case eOpcode::opcode_EXA1:
+            {
+                program_counter += (_key_state[instance] >> (vx & 0xF)) & 0b1 ? 0U : 2U;
+            }
+            break;
+            case eOpcode::opcode_FX07:
+            {
+                vx = _delay_time[instance];
+            }
+            break;
+            case eOpcode::opcode_FX0A:
+            {
+                if (_pending_press[instance] == -1)
+                {
+                    _waiting_for_key[instance] = 1U;
+                    _key_register[instance] = instruction.x;
+                    break;
+                }
+
+                vx = static_cast<uint8_t>(_pending_press[instance]);
+                _pending_press[instance] = -1;
+            }
+            break;
+            case eOpcode::opcode_FX15:
+            {
+                _delay_time[instance] = vx;
+            }
+            break;
+            case eOpcode::opcode_FX18:
+            {
+                _sound_time[instance] = vx;
+            }
+            break;
+            case eOpcode::opcode_FX1E:
+            {
+                register_i += vx;
+                if (register_i > RAM_SIZE)
+                {
+                    register_i -= (RAM_SIZE + 1);
+                }
+            }
+            break;
+            case eOpcode::opcode_FX29:
+            {
+                register_i = FONT_START_LOCATION + instruction.n * FONT_SIZE;
+            }
+            break;
+            case eOpcode::opcode_FX33:
+            {
+                ram_byte(register_i, instance) = vx / 100;
+                ram_byte(register_i + 1, instance) = (vx % 100) / 10;
+                ram_byte(register_i + 2, instance) = vx % 10;
+            }
+            break;
+            case eOpcode::opcode_FX55:
+            {
+                for (int32_t i = 0; i <= instruction.x; i++)
+                {
+                    ram_byte(register_i + i, instance) = reg(i, instance);
+                }
+            }
+            break;
+            case eOpcode::opcode_FX65:
+            {
+                for (int32_t i = 0; i <= instruction.x; i++)
+                {
+                    reg(i, instance) = ram_byte(register_i + i, instance);
+                }
+            }
+            break;
+            default:
+            {
+                thoth::error("Invalid operation %x04", instruction.opcode);
+                std::abort();
+            }
+        }
+    }
+
+    void cLockstepBatch::tick_timers()
+    {
+#if CHIP8_SIMD_LOCKSTEP
+        if (_vector_kernels)
+        {
+            sLaneArrays lanes {_registers.data(),
+                               _ram.data(),
+                               _register_i.data(),
+                               _program_counter.data(),
+                               _delay_time.data(),
+                               _sound_time.data(),
+                               _pending.data(),
+                               _group.data(),
+                               _stride};
+            tick_timers_avx2(lanes);
+            return;
+        }
+#endif
+
+        for (int32_t instance = 0; instance < _instance_count; instance++)
+        {
+            _delay_time[instance] -= _delay_time[instance] > 0 ? 1 : 0;
+            _sound_time[instance] -= _sound_time[instance] > 0 ? 1 : 0;
+        }
+    }
+
+    uint8_t& cLockstepBatch::reg(int32_t index, int32_t instance)
+    {
+        return _registers[index * _stride + instance];
+    }
+
+    uint8_t& cLockstepBatch::ram_byte(int32_t address, int32_t instance)
+    {
+        assert(address < RAM_SIZE);
+        return _ram[address * _stride + instance];
+    }
+}
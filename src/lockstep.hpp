@@ -0,0 +1,107 @@
+#ifndef CHIP8_SRC_LOCKSTEPHPP
+#define CHIP8_SRC_LOCKSTEPHPP
+
+#include "display.hpp"
+#include "ram.hpp"
+#include "random.hpp"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace chip8
+{
+    constexpr int32_t LOCKSTEP_LANE_BLOCK = 32; // Instances per AVX2 register of bytes.
+    constexpr int32_t MIN_LOCKSTEP_GROUP = 8;   // Fewer instances at the same instruction run one by one.
+    constexpr int32_t MAX_LOCKSTEP_GROUPS = 4;  // Groups tried per cycle before the rest run one by one.
+
+    // Many instances of the same machine, stepped together one instruction per cycle.
+    // Registers, I, program counters, timers and ram are stored as structure of arrays, instance index fastest,
+    // so one vector load reads the same register or ram byte of 32 instances. Instances whose program counter and
+    // opcode match run as a group through AVX2 kernels. Diverged instances are peeled off and interpreted one by one,
+    // and rejoin a group as soon as they reach the same instruction again.
+    // Each instance ends in exactly the state a cProcessor running the same ROM and input would.
+    class cLockstepBatch
+    {
+      public:
+        cLockstepBatch(int32_t instance_count, int32_t instructions_per_second, int32_t stack_depth = DEFAULT_STACK_DEPTH);
+
+        // Loads the same ROM into every instance. Returns -1 if it does not fit.
+        int32_t load_rom(const uint8_t* data, int32_t size);
+
+        void set_random_seed(int32_t instance, uint64_t seed);
+
+        // Key changes are seen from the next cycle on.
+        void press_key(int32_t instance, uint8_t key_id);
+        void release_key(int32_t instance, uint8_t key_id);
+
+        // Runs every instance for the given number of cycles, with the timers ticking at 60 Hz of emulated time.
+        int64_t run(int64_t cycles);
+
+        // Without AVX2 on the host every instance is interpreted one by one. Returns false if the host lacks it.
+        bool set_vector_kernels(bool enabled);
+        bool get_vector_kernels() const;
+
+        int32_t  get_instance_count() const;
+        uint64_t hash_instance(int32_t instance) const; // See hash_machine_state.
+
+        uint8_t         get_register(int32_t instance, int32_t index) const;
+        uint16_t        get_register_i(int32_t instance) const;
+        uint16_t        get_program_counter(int32_t instance) const;
+        const cDisplay& get_display(int32_t instance) const;
+
+        int64_t get_executed() const;        // Instructions over every instance.
+        int64_t get_vector_executed() const; // Part of get_executed() that ran in lockstep groups.
+        int64_t get_halted_cycles() const;   // Instance cycles spent waiting for a key.
+        int64_t get_stack_faults() const;    // Calls past the stack depth and returns without a call, see cRam.
+        int64_t get_frames() const;
+
+      private:
+        void    step();
+        int32_t build_group(uint16_t program_counter, uint16_t opcode); // Returns the group size.
+        void    execute_group(uint16_t program_counter, uint16_t opcode);
+        void    execute_instance(int32_t instance);
+        void    tick_timers();
+
+        uint8_t& reg(int32_t index, int32_t instance);
+        uint8_t& ram_byte(int32_t address, int32_t instance);
+
+        int32_t _instance_count;
+        int32_t _stride; // Instance count rounded up to LOCKSTEP_LANE_BLOCK.
+        int32_t _instructions_per_second;
+        int64_t _tick_accumulator {0};
+
+        // Structure of arrays. Entry [index * _stride + instance].
+        std::vector<uint8_t>  _registers;
+        std::vector<uint8_t>  _ram;
+        std::vector<uint16_t> _register_i;
+        std::vector<uint16_t> _program_counter;
+        std::vector<uint8_t>  _delay_time;
+        std::vector<uint8_t>  _sound_time;
+
+        // Cold per instance state, only touched by the one by one path.
+        int32_t                                            _stack_depth;
+        std::vector<std::array<uint16_t, MAX_STACK_DEPTH>> _stacks;
+        std::vector<int32_t>                               _stack_pointers;
+        std::vector<std::unique_ptr<cDisplay>>             _displays; // Not movable, they point into their own framebuffer.
+        std::vector<cRandom>                               _random;
+        std::vector<uint16_t>                              _key_state;
+        std::vector<int8_t>                                _pending_press;
+        std::vector<uint8_t>                               _waiting_for_key;
+        std::vector<uint8_t>                               _key_register;
+
+        // 0xFF for instances that still have to run this cycle, and for the members of the current group.
+        std::vector<uint8_t> _pending;
+        std::vector<uint8_t> _group;
+
+        bool    _vector_kernels {false};
+        int64_t _executed {0};
+        int64_t _vector_executed {0};
+        int64_t _halted_cycles {0};
+        int64_t _stack_faults {0};
+        int64_t _frames {0};
+    };
+}
+
+#endif // CHIP8_SRC_LOCKSTEPHPP
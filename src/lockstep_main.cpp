@@ -0,0 +1,144 @@
+#include "headless.hpp"
+#include "lockstep.hpp"
+#include "machine.hpp"
+#include "scheduler.hpp"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+// Runs many instances of one ROM, each with its own seed, in a lockstep batch and then as independent processors.
+// Prints the aggregate instructions per second of both and checks that every instance ends in the same state.
+int main(int argc, char* argv[])
+{
+    const char* rom_path {nullptr};
+    int32_t     instance_count {256};
+    int64_t     cycles {100000};
+    int32_t     instructions_per_second {chip8::DEFAULT_INSTRUCTIONS_PER_SECOND};
+    uint64_t    base_seed {chip8::DEFAULT_RANDOM_SEED};
+    bool        vector_kernels {true};
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strncmp(argv[i], "--rom=", 6) == 0)
+        {
+            rom_path = argv[i] + 6;
+        }
+        else if (std::strncmp(argv[i], "--instances=", 12) == 0 && std::atoi(argv[i] + 12) > 0)
+        {
+            instance_count = std::atoi(argv[i] + 12);
+        }
+        else if (std::strncmp(argv[i], "--cycles=", 9) == 0)
+        {
+            cycles = std::atoll(argv[i] + 9);
+        }
+        else if (std::strncmp(argv[i], "--ips=", 6) == 0 && std::atoi(argv[i] + 6) > 0)
+        {
+            instructions_per_second = std::atoi(argv[i] + 6);
+        }
+        else if (std::strncmp(argv[i], "--seed=", 7) == 0)
+        {
+            base_seed = std::strtoull(argv[i] + 7, nullptr, 0);
+        }
+        else if (std::strcmp(argv[i], "--scalar") == 0)
+        {
+            vector_kernels = false;
+        }
+        else
+        {
+            rom_path = nullptr;
+            break;
+        }
+    }
+
+    if (rom_path == nullptr)
+    {
+        std::cout << "Usage: 8chip_lockstep --rom=PATH [--instances=N] [--cycles=N] [--ips=N] [--seed=N] [--scalar]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream rom_file {rom_path, std::ios::binary | std::ios::in};
+    if (!rom_file.is_open())
+    {
+        std::cout << "[ERROR] Could not open rom " << rom_path << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<uint8_t> rom {std::istreambuf_iterator<char>(rom_file), std::istreambuf_iterator<char>()};
+
+    // Instance i is seeded with base_seed + i.
+    chip8::cLockstepBatch batch {instance_count, instructions_per_second};
+    if (batch.load_rom(rom.data(), static_cast<int32_t>(rom.size())) != 0)
+    {
+        std::cout << "[ERROR] Rom " << rom_path << " does not fit in ram" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (!batch.set_vector_kernels(vector_kernels))
+    {
+        std::cout << "[WARNING] Host has no AVX2, every instance is interpreted one by one" << std::endl;
+    }
+
+    for (int32_t i = 0; i < instance_count; i++)
+    {
+        batch.set_random_seed(i, base_seed + i);
+    }
+
+    auto batch_start = std::chrono::steady_clock::now();
+    batch.run(cycles);
+    std::chrono::duration<double> batch_elapsed = std::chrono::steady_clock::now() - batch_start;
+
+    // The same work on one cProcessor per instance, without idle loop skipping.
+    std::vector<uint64_t>         single_hashes(instance_count);
+    std::chrono::duration<double> single_elapsed {0.0};
+
+    for (int32_t i = 0; i < instance_count; i++)
+    {
+        chip8::cMachine machine;
+        chip8::cRam&    ram = *machine.get_ram();
+        ram.load_rom(rom.data(), static_cast<int32_t>(rom.size()));
+
+        chip8::cDisplay&   display = *machine.get_display();
+        chip8::cKeyboard&  keyboard = *machine.get_keyboard();
+        chip8::cTimer&     delay_timer = *machine.get_delay_timer();
+        chip8::cTimer&     sound_timer = *machine.get_sound_timer();
+        chip8::cProcessor& processor = *machine.get_processor();
+        processor.set_random_seed(base_seed + i);
+
+        chip8::cScheduler scheduler {instructions_per_second, chip8::cScheduler::ePacing::unthrottled};
+        scheduler.set_idle_skipping(false);
+
+        auto single_start = std::chrono::steady_clock::now();
+        scheduler.run(cycles, INT64_MAX, &processor, &ram, &display, &keyboard, &delay_timer, &sound_timer);
+        single_elapsed += std::chrono::steady_clock::now() - single_start;
+
+        single_hashes[i] = chip8::hash_machine_state(&processor, &ram, &display, &delay_timer, &sound_timer);
+    }
+
+    int32_t mismatches = 0;
+    for (int32_t i = 0; i < instance_count; i++)
+    {
+        mismatches += batch.hash_instance(i) == single_hashes[i] ? 0 : 1;
+    }
+
+    int64_t total = static_cast<int64_t>(instance_count) * cycles;
+    std::printf("[INFO] Lockstep batch: %" PRId64 " instructions in %.3f s (%.0f instructions/s), %.1f%% in lockstep groups\n",
+                batch.get_executed(),
+                batch_elapsed.count(),
+                batch_elapsed.count() > 0.0 ? batch.get_executed() / batch_elapsed.count() : 0.0,
+                batch.get_executed() > 0 ? 100.0 * batch.get_vector_executed() / batch.get_executed() : 0.0);
+    std::printf("[INFO] Independent processors: %" PRId64 " cycles in %.3f s (%.0f instructions/s)\n",
+                total,
+                single_elapsed.count(),
+                single_elapsed.count() > 0.0 ? total / single_elapsed.count() : 0.0);
+    std::printf("[INFO] %d of %d instances differ from their processor\n", mismatches, instance_count);
+
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
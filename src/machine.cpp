@@ -0,0 +1,119 @@
+#include "machine.hpp"
+
+#include "save_state.hpp"
+
+namespace chip8
+{
+    cMachine::cMachine(int32_t stack_depth)
+      : _ram(&_state, PROGRAM_START_LOCATION, stack_depth)
+      , _display(&_state)
+      , _keyboard(&_state)
+      , _delay_timer(cTimer::eType::delay, &_state)
+      , _sound_timer(cTimer::eType::sound, &_state)
+      , _processor(&_state, PROGRAM_START_LOCATION)
+    {
+    }
+
+    const sMachineState& cMachine::get_state() const
+    {
+        return _state;
+    }
+
+    void cMachine::save_snapshot(sMachineState* snapshot) const
+    {
+        *snapshot = _state;
+    }
+
+    void cMachine::load_snapshot(const sMachineState& snapshot)
+    {
+        // Only ram that differs is reported, so decode caches survive going back to a nearby state.
+        int32_t run_start = -1;
+        for (int32_t i = 0; i <= RAM_SIZE; i++)
+        {
+            bool differs = i < RAM_SIZE && _state.ram[i] != snapshot.ram[i];
+
+            if (differs && run_start < 0)
+            {
+                run_start = i;
+            }
+            else if (!differs && run_start >= 0)
+            {
+                _ram.mark_written(run_start, i - run_start);
+                run_start = -1;
+            }
+        }
+
+        _state = snapshot;
+        _display.mark_dirty();
+    }
+
+    int32_t cMachine::save_state(uint8_t* buffer, int32_t capacity) const
+    {
+        return chip8::save_state(_state, buffer, capacity);
+    }
+
+    int32_t cMachine::load_state(const uint8_t* buffer, int32_t size)
+    {
+        sMachineState loaded;
+        int32_t       read = chip8::load_state(buffer, size, &loaded);
+
+        return read < 0 || apply_loaded_state(loaded) != 0 ? -1 : read;
+    }
+
+    int32_t cMachine::save_state_file(const std::string& path) const
+    {
+        return chip8::save_state_file(_state, path);
+    }
+
+    int32_t cMachine::load_state_file(const std::string& path)
+    {
+        sMachineState loaded;
+        if (chip8::load_state_file(path, &loaded) != 0)
+        {
+            return -1;
+        }
+
+        return apply_loaded_state(loaded);
+    }
+
+    int32_t cMachine::apply_loaded_state(const sMachineState& loaded)
+    {
+        if (loaded.stack_pointer > _ram.get_stack_depth())
+        {
+            return -1;
+        }
+
+        load_snapshot(loaded);
+        return 0;
+    }
+
+    cProcessor* cMachine::get_processor()
+    {
+        return &_processor;
+    }
+
+    cRam* cMachine::get_ram()
+    {
+        return &_ram;
+    }
+
+    cDisplay* cMachine::get_display()
+    {
+        return &_display;
+    }
+
+    cKeyboard* cMachine::get_keyboard()
+    {
+        return &_keyboard;
+    }
+
+    cTimer* cMachine::get_delay_timer()
+    {
+        return &_delay_timer;
+    }
+
+    cTimer* cMachine::get_sound_timer()
+    {
+        return &_sound_timer;
+    }
+}
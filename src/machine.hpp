@@ -0,0 +1,60 @@
+#ifndef CHIP8_SRC_MACHINEHPP
+#define CHIP8_SRC_MACHINEHPP
+
+#include "display.hpp"
+#include "keyboard.hpp"
+#include "machine_state.hpp"
+#include "processor.hpp"
+#include "ram.hpp"
+#include "timer.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace chip8
+{
+    // A whole machine: one sMachineState and the ram, display, keyboard, timer and processor views over it.
+    // Snapshots are plain copies of that state.
+    class cMachine
+    {
+      public:
+        explicit cMachine(int32_t stack_depth = DEFAULT_STACK_DEPTH);
+
+        cMachine(const cMachine&) = delete;
+        cMachine& operator=(const cMachine&) = delete;
+
+        const sMachineState& get_state() const;
+
+        // Copies the state out. Host side settings (dispatch mode, renderer, queued key events) are not part of it.
+        void save_snapshot(sMachineState* snapshot) const;
+        // Copies the state in. Decode caches drop whatever covered ram that changed, the next frame redraws the whole screen.
+        void load_snapshot(const sMachineState& snapshot);
+
+        // Serialized snapshots, see save_state.hpp. Loading fails, leaving the machine as it was, for invalid states
+        // and for states with more calls on the stack than this machine's stack depth.
+        int32_t save_state(uint8_t* buffer, int32_t capacity) const;
+        int32_t load_state(const uint8_t* buffer, int32_t size);
+        int32_t save_state_file(const std::string& path) const;
+        int32_t load_state_file(const std::string& path);
+
+        cProcessor* get_processor();
+        cRam*       get_ram();
+        cDisplay*   get_display();
+        cKeyboard*  get_keyboard();
+        cTimer*     get_delay_timer();
+        cTimer*     get_sound_timer();
+
+      private:
+        int32_t apply_loaded_state(const sMachineState& loaded);
+
+        sMachineState _state; // Views below point into it, so it comes first.
+        cRam          _ram;
+        cDisplay      _display;
+        cKeyboard     _keyboard;
+        cTimer        _delay_timer;
+        cTimer        _sound_timer;
+        cProcessor    _processor;
+    };
+}
+
+#endif // CHIP8_SRC_MACHINEHPP
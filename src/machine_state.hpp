@@ -0,0 +1,40 @@
+#ifndef CHIP8_SRC_MACHINESTATEHPP
+#define CHIP8_SRC_MACHINESTATEHPP
+
+#include "display.hpp"
+#include "processor.hpp"
+#include "ram.hpp"
+#include "random.hpp"
+
+#include <cstdint>
+#include <type_traits>
+
+namespace chip8
+{
+    // Everything a running machine is, in one block. cProcessor, cRam, cDisplay, cKeyboard and cTimer are views over it,
+    // so a snapshot is a plain copy. The hot fields come first and share the first cache line.
+    // A default constructed state is a machine at power on: cleared, no key pending, generator at the default seed.
+    struct sMachineState
+    {
+        uint8_t  registers[REGISTER_COUNT] {};
+        uint16_t register_i {0U};
+        uint16_t program_counter {PROGRAM_START_LOCATION};
+        uint8_t  delay_time {0U};
+        uint8_t  sound_time {0U};
+        uint8_t  waiting_for_key {0U}; // Halted on FX0A.
+        uint8_t  key_register {0U};    // Register the awaited key goes to.
+        uint16_t key_state {0U};       // Bit n set while key n is down.
+        int8_t   pending_press {-1};   // Last press not yet awaited.
+        int32_t  stack_pointer {0};    // Stack entries in use.
+        uint64_t random_seed {DEFAULT_RANDOM_SEED};
+        uint64_t random_state {cRandom::get_seeded_state(DEFAULT_RANDOM_SEED)};
+
+        uint16_t stack[MAX_STACK_DEPTH] {};
+        uint64_t rows[DISPLAY_HEIGHT * DISPLAY_WORDS_PER_ROW] {};
+        uint8_t  ram[RAM_SIZE] {};
+    };
+
+    static_assert(std::is_trivially_copyable<sMachineState>::value, "Snapshots copy the state as raw bytes");
+}
+
+#endif // CHIP8_SRC_MACHINESTATEHPP
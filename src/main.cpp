@@ -1,47 +1,440 @@
 #include "display.hpp"
+#include "headless.hpp"
+#include "input_script.hpp"
 #include "keyboard.hpp"
+#include "machine.hpp"
 #include "processor.hpp"
 #include "ram.hpp"
+#include "render_thread.hpp"
+#include "rewind.hpp"
+#include "run_ahead.hpp"
+#include "scheduler.hpp"
+#include "terminal_input.hpp"
 #include "timer.hpp"
+#include "trace.hpp"
 
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <optional>
+#include <string>
 #include <unistd.h>
+#include <utility>
+#include <vector>
 
-int main()
+int main(int argc, char* argv[])
 {
+    chip8::cProcessor::eDispatchMode dispatch_mode {chip8::cProcessor::eDispatchMode::switch_decoder};
+    bool                             profile_pairs {false};
+    bool                             headless {false};
+    bool                             real_time {false};
+    bool                             skip_idle_loops {true};
+    int64_t                          cycles {-1};
+    int64_t                          frames {-1};
+    int32_t                          instructions_per_second {chip8::DEFAULT_INSTRUCTIONS_PER_SECOND};
+    uint64_t                         random_seed {chip8::DEFAULT_RANDOM_SEED};
+    bool                             seeded {false};
+    int32_t                          stack_depth {chip8::DEFAULT_STACK_DEPTH};
+    int32_t                          rewind_seconds {0};
+    int32_t                          run_ahead_frames {0};
+    std::string                      rom_path {"../data/octojam6title.ch8"};
+    std::string                      load_state_path;
+    std::string                      save_state_path;
+    std::string                      trace_path;
+    std::string                      record_input_path;
+    std::string                      replay_input_path;
 
-    std::srand(0); // TODO: Use actual random.
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--dispatch=switch") == 0)
+        {
+            dispatch_mode = chip8::cProcessor::eDispatchMode::switch_decoder;
+        }
+        else if (std::strcmp(argv[i], "--dispatch=table") == 0)
+        {
+            dispatch_mode = chip8::cProcessor::eDispatchMode::table;
+        }
+        else if (std::strcmp(argv[i], "--dispatch=cache") == 0)
+        {
+            dispatch_mode = chip8::cProcessor::eDispatchMode::decode_cache;
+        }
+        else if (std::strcmp(argv[i], "--dispatch=block") == 0)
+        {
+            dispatch_mode = chip8::cProcessor::eDispatchMode::block;
+        }
+        else if (std::strcmp(argv[i], "--dispatch=jit") == 0)
+        {
+            dispatch_mode = chip8::cProcessor::eDispatchMode::jit;
+        }
+        else if (std::strcmp(argv[i], "--dispatch=threaded") == 0)
+        {
+            dispatch_mode = chip8::cProcessor::eDispatchMode::threaded;
+        }
+        else if (std::strcmp(argv[i], "--profile-pairs") == 0)
+        {
+            profile_pairs = true;
+        }
+        else if (std::strcmp(argv[i], "--headless") == 0)
+        {
+            headless = true;
+        }
+        else if (std::strcmp(argv[i], "--realtime") == 0)
+        {
+            real_time = true;
+        }
+        else if (std::strcmp(argv[i], "--no-idle-skip") == 0)
+        {
+            skip_idle_loops = false;
+        }
+        else if (std::strncmp(argv[i], "--cycles=", 9) == 0)
+        {
+            cycles = std::atoll(argv[i] + 9);
+        }
+        else if (std::strncmp(argv[i], "--frames=", 9) == 0)
+        {
+            frames = std::atoll(argv[i] + 9);
+        }
+        else if (std::strncmp(argv[i], "--ips=", 6) == 0 && std::atoi(argv[i] + 6) > 0)
+        {
+            instructions_per_second = std::atoi(argv[i] + 6);
+        }
+        else if (std::strncmp(argv[i], "--seed=", 7) == 0)
+        {
+            random_seed = std::strtoull(argv[i] + 7, nullptr, 0);
+            seeded = true;
+        }
+        else if (std::strncmp(argv[i], "--stack-depth=", 14) == 0 && std::atoi(argv[i] + 14) > 0 && std::atoi(argv[i] + 14) <= chip8::MAX_STACK_DEPTH)
+        {
+            stack_depth = std::atoi(argv[i] + 14);
+        }
+        else if (std::strncmp(argv[i], "--rom=", 6) == 0)
+        {
+            rom_path = argv[i] + 6;
+        }
+        else if (std::strncmp(argv[i], "--rewind=", 9) == 0 && std::atoi(argv[i] + 9) > 0)
+        {
+            rewind_seconds = std::atoi(argv[i] + 9);
+        }
+        else if (std::strncmp(argv[i], "--run-ahead=", 12) == 0 && std::atoi(argv[i] + 12) > 0 && std::atoi(argv[i] + 12) <= chip8::MAX_RUN_AHEAD_FRAMES)
+        {
+            run_ahead_frames = std::atoi(argv[i] + 12);
+        }
+        else if (std::strncmp(argv[i], "--load-state=", 13) == 0)
+        {
+            load_state_path = argv[i] + 13;
+        }
+        else if (std::strncmp(argv[i], "--save-state=", 13) == 0)
+        {
+            save_state_path = argv[i] + 13;
+        }
+        else if (std::strncmp(argv[i], "--trace=", 8) == 0)
+        {
+            trace_path = argv[i] + 8;
+        }
+        else if (std::strncmp(argv[i], "--record-input=", 15) == 0)
+        {
+            record_input_path = argv[i] + 15;
+        }
+        else if (std::strncmp(argv[i], "--replay-input=", 15) == 0)
+        {
+            replay_input_path = argv[i] + 15;
+        }
+        else
+        {
+            std::cout << "[ERROR] Unknown argument " << argv[i] << "\n";
+            std::cout << "Usage: 8chip [--rom=PATH] [--dispatch=switch|table|cache|block|jit|threaded] [--profile-pairs]\n"
+                      << "             [--headless | --realtime] [--cycles=N] [--frames=N] [--ips=N] [--no-idle-skip] [--seed=N]\n"
+                      << "             [--stack-depth=1-64] [--load-state=PATH] [--save-state=PATH] [--rewind=SECONDS]\n"
+                      << "             [--run-ahead=1-8] [--trace=PATH] [--record-input=PATH] [--replay-input=PATH]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Running ahead executes every frame more than once, which would all end up in the trace.
+    if (!trace_path.empty() && run_ahead_frames > 0)
+    {
+        std::cout << "[ERROR] --trace can not be combined with --run-ahead" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Keys only come from the terminal in real time. Rewinding takes back frames whose input was already recorded.
+    if (!record_input_path.empty() && (!real_time || rewind_seconds > 0))
+    {
+        std::cout << "[ERROR] --record-input needs --realtime and can not be combined with --rewind" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // The keyboard queue takes events from one thread only, and in real time that is the terminal reader.
+    if (!replay_input_path.empty() && real_time)
+    {
+        std::cout << "[ERROR] --replay-input can not be combined with --realtime" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<chip8::sInputEvent> replay_events;
+    if (!replay_input_path.empty() && chip8::load_input_script(replay_input_path, &replay_events) != 0)
+    {
+        std::cout << "[ERROR] Can not read input script " << replay_input_path << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    chip8::cInputPlayback playback {std::move(replay_events)};
 
-    chip8::cRam ram {chip8::RAM_SIZE, chip8::PROGRAM_START_LOCATION};
+    chip8::cMachine machine {stack_depth};
+    chip8::cRam&    ram = *machine.get_ram();
 
-    if (ram.load_rom("../data/octojam6title.ch8") != 0)
+    // A save state already holds the ROM, it replaces booting from one.
+    if (!load_state_path.empty())
+    {
+        if (machine.load_state_file(load_state_path) != 0)
+        {
+            std::cout << "[ERROR] Can not load state " << load_state_path << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    else if (ram.load_rom(rom_path) != 0)
     {
         return EXIT_FAILURE;
     }
 
-    ram.print();
+    if (!headless && !real_time)
+    {
+        ram.print();
+    }
 
-    chip8::cDisplay display {chip8::DISPLAY_HEIGHT, chip8::DISPLAY_WIDTH};
+    chip8::cDisplay& display = *machine.get_display();
     // display.clear_pixels();
 
-    chip8::cKeyboard keyboard;
+    chip8::cKeyboard& keyboard = *machine.get_keyboard();
+
+    chip8::cTimer& delay_timer = *machine.get_delay_timer();
+    chip8::cTimer& sound_timer = *machine.get_sound_timer();
+
+    chip8::cProcessor& processor = *machine.get_processor();
+    processor.set_dispatch_mode(dispatch_mode);
+    processor.set_pair_profiling(profile_pairs);
+
+    // A loaded state keeps its generator going unless a seed is given.
+    if (seeded || load_state_path.empty())
+    {
+        processor.set_random_seed(random_seed);
+    }
+
+    // Every instruction goes to the trace, see 8chip_trace for reading it.
+    chip8::cTraceRecorder trace;
+    if (!trace_path.empty())
+    {
+        if (trace.open(trace_path) != 0)
+        {
+            std::cout << "[ERROR] Can not write trace " << trace_path << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        processor.set_trace_recorder(&trace);
+    }
+
+    if (headless)
+    {
+        // Without any limit, run a million instructions.
+        int64_t cycle_limit = cycles >= 0 ? cycles : (frames >= 0 ? INT64_MAX : 1000000);
+        int64_t frame_limit = frames >= 0 ? frames : INT64_MAX;
+
+        chip8::sHeadlessResult result = chip8::run_headless(cycle_limit,
+                                                            frame_limit,
+                                                            instructions_per_second,
+                                                            skip_idle_loops,
+                                                            &processor,
+                                                            &ram,
+                                                            &display,
+                                                            &keyboard,
+                                                            &delay_timer,
+                                                            &sound_timer,
+                                                            &playback);
+
+        std::printf("[INFO] Executed %" PRId64 " instructions (%" PRId64 " frames) in %.3f s (%.0f instructions/s)\n",
+                    result.executed,
+                    result.frames,
+                    result.seconds,
+                    result.seconds > 0.0 ? result.executed / result.seconds : 0.0);
+        std::printf("[INFO] Skipped %" PRId64 " instructions of idle loops, halted for %" PRId64 " cycles\n", result.idle, result.halted);
+        std::printf("[INFO] State hash %016" PRIx64 "\n", result.state_hash);
+
+        if (!replay_input_path.empty())
+        {
+            std::printf("[INFO] Replayed %" PRId64 " key events\n", playback.get_applied());
+        }
+
+        if (ram.get_stack_overflows() > 0 || ram.get_stack_underflows() > 0)
+        {
+            std::printf("[WARNING] %" PRId64 " stack overflows, %" PRId64 " stack underflows\n", ram.get_stack_overflows(), ram.get_stack_underflows());
+        }
+    }
+    else if (real_time)
+    {
+        // Runs until a limit is reached or escape is pressed. Every frame is handed to the render thread.
+        chip8::cTerminalInput input {&keyboard};
+        input.start();
+
+        chip8::cRenderThread renderer {chip8::DISPLAY_HEIGHT, chip8::DISPLAY_WIDTH};
+        renderer.start();
+
+        // Every frame goes into the rewind history. While backspace is held, each frame is replaced by the one before.
+        std::optional<chip8::cRewindBuffer> rewind;
+        chip8::sMachineState                previous;
+        if (rewind_seconds > 0)
+        {
+            rewind.emplace(rewind_seconds * chip8::TIMER_FREQUENCY);
+        }
+
+        // Shows every frame as it will be a few frames later, so input shows up sooner.
+        std::optional<chip8::cRunAhead> run_ahead;
+        if (run_ahead_frames > 0)
+        {
+            run_ahead.emplace(&machine, run_ahead_frames, instructions_per_second, skip_idle_loops);
+        }
+
+        // Key events are stamped with the frame that ended before the emulation took them, see cInputRecorder.
+        chip8::cInputRecorder recorder;
+        if (!record_input_path.empty())
+        {
+            keyboard.set_event_recorder(&recorder);
+        }
+
+        playback.apply_due_events(0, &keyboard);
+
+        chip8::cScheduler scheduler {instructions_per_second, chip8::cScheduler::ePacing::real_time};
+        scheduler.set_frame_listener(
+            [&machine, &display, &keyboard, &input, &renderer, &scheduler, &rewind, &previous, &run_ahead, &recorder, &playback]()
+            {
+                recorder.set_position(scheduler.get_frames(), scheduler.get_executed());
+                playback.apply_due_events(scheduler.get_frames(), &keyboard);
+
+                if (rewind)
+                {
+                    if (!input.is_rewind_held())
+                    {
+                        rewind->push(machine.get_state());
+                    }
+                    else if (rewind->step_back(&previous))
+                    {
+                        machine.load_snapshot(previous);
+                    }
+                }
+
+                if (run_ahead)
+                {
+                    run_ahead->run([&renderer](const chip8::cDisplay& ahead) { renderer.publish(ahead); });
+                }
+                else
+                {
+                    renderer.publish(display);
+                }
+
+                if (input.is_quit_requested())
+                {
+                    scheduler.request_stop();
+                }
+            });
+        scheduler.set_idle_skipping(skip_idle_loops);
+        scheduler.run(cycles >= 0 ? cycles : INT64_MAX, frames >= 0 ? frames : INT64_MAX, &processor, &ram, &display, &keyboard, &delay_timer, &sound_timer);
+
+        renderer.stop();
+        input.stop();
+
+        std::printf("[INFO] Presented %" PRId64 " of %" PRId64 " frames (%" PRId64 " dropped), latency %.3f ms average, %.3f ms max\n",
+                    renderer.get_presented_frames(),
+                    renderer.get_published_frames(),
+                    renderer.get_dropped_frames(),
+                    renderer.get_average_latency() / 1e6,
+                    renderer.get_max_latency() / 1e6);
 
-    chip8::cTimer delay_timer {chip8::cTimer::eType::delay};
-    chip8::cTimer sound_timer {chip8::cTimer::eType::sound};
+        std::printf("[INFO] Frame work %.3f ms average, %.3f ms max, %" PRId64 " frames over the %.3f ms budget\n",
+                    scheduler.get_average_frame_work() / 1e6,
+                    scheduler.get_max_frame_work() / 1e6,
+                    scheduler.get_frames_over_budget(),
+                    1e3 / chip8::TIMER_FREQUENCY);
 
-    chip8::cProcessor processor {chip8::PROGRAM_START_LOCATION, chip8::REGISTER_COUNT};
+        if (run_ahead)
+        {
+            std::printf("[INFO] Running %d frames ahead took %.3f ms average, %.3f ms max\n",
+                        run_ahead->get_frames(),
+                        run_ahead->get_average_run_time() / 1e6,
+                        run_ahead->get_max_run_time() / 1e6);
+        }
 
-    for (int i = 0; i < 20; i++)
+        if (!record_input_path.empty())
+        {
+            keyboard.set_event_recorder(nullptr);
+
+            // Replaying needs the same start, seed and speed.
+            std::string start = load_state_path.empty() ? "--rom=" + rom_path : "--load-state=" + load_state_path;
+            std::string seed = seeded || load_state_path.empty() ? " --seed=" + std::to_string(processor.get_random_seed()) : "";
+            std::string depth = stack_depth != chip8::DEFAULT_STACK_DEPTH ? " --stack-depth=" + std::to_string(stack_depth) : "";
+            std::string speed = " --ips=" + std::to_string(instructions_per_second);
+            std::string header = "8chip input script. Replay with\n  8chip " + start + seed + depth + speed + " --replay-input=" + record_input_path + " --headless --frames=" +
+                                 std::to_string(scheduler.get_frames());
+
+            if (chip8::save_input_script(record_input_path, recorder.get_events(), header) != 0)
+            {
+                std::cout << "[ERROR] Can not write input script " << record_input_path << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            std::printf("[INFO] Recorded %zu key events over %" PRId64 " frames\n", recorder.get_events().size(), scheduler.get_frames());
+        }
+
+        if (rewind)
+        {
+            std::printf("[INFO] Rewind history of %d frames in %" PRId64 " bytes (%" PRId64 " reserved)\n",
+                        rewind->get_frame_count(),
+                        rewind->get_used_bytes(),
+                        rewind->get_arena_bytes());
+        }
+    }
+    else
     {
+        for (int i = 0; i < 20; i++)
+        {
 
-        // display.draw_frame();
-        std::cout << "[INFO] Frame number " << i << std::endl;
-        std::cout << "\n\n";
-        processor.execute_next_instruction(&ram, &display, &keyboard, &delay_timer, &sound_timer);
+            // display.draw_frame();
+            std::cout << "[INFO] Frame number " << i << std::endl;
+            std::cout << "\n\n";
+            processor.execute_next_instruction(&ram, &display, &keyboard, &delay_timer, &sound_timer);
+
+            // ram.print();
+            sleep(1);
+        }
+    }
+
+    if (!trace_path.empty())
+    {
+        processor.set_trace_recorder(nullptr);
 
-        // ram.print();
-        sleep(1);
+        if (trace.close() != 0)
+        {
+            std::cout << "[ERROR] Can not write trace " << trace_path << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        std::printf("[INFO] Traced %" PRId64 " instructions over %" PRId64 " cycles\n", trace.get_records(), trace.get_cycles());
+    }
+
+    if (!save_state_path.empty() && machine.save_state_file(save_state_path) != 0)
+    {
+        std::cout << "[ERROR] Can not save state " << save_state_path << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (profile_pairs)
+    {
+        std::cout << "[INFO] Most frequent adjacent instruction pairs:\n";
+        for (const chip8::cProcessor::sOpcodePairCount& pair : processor.get_pair_profile())
+        {
+            std::cout << "  " << chip8::get_opcode_name(pair.first) << " + " << chip8::get_opcode_name(pair.second) << ": " << pair.count << "\n";
+        }
     }
 
     return EXIT_SUCCESS;
@@ -0,0 +1,282 @@
+#include "opcode.hpp"
+
+#include <cstdio>
+
+namespace chip8
+{
+    eOpcode classify_opcode(uint16_t opcode)
+    {
+        // Opcode = Nibble 1234
+        uint8_t nibble1 = (opcode >> 12) & 0x000F;
+        uint8_t nibble2 = (opcode >> 8) & 0x000F;
+        uint8_t nibble3 = (opcode >> 4) & 0x000F;
+        uint8_t nibble4 = opcode & 0x000F;
+
+        switch (nibble1)
+        {
+            case 0x00:
+            {
+                if (nibble2 == 0x0 && nibble3 == 0xE && nibble4 == 0xE)
+                {
+                    return eOpcode::opcode_00EE;
+                }
+
+                if (nibble2 == 0xE && nibble3 == 0x0 && nibble4 == 0x0)
+                {
+                    return eOpcode::opcode_0E00;
+                }
+
+                return eOpcode::invalid;
+            }
+            case 0x01:
+                return eOpcode::opcode_1NNN;
+            case 0x02:
+                return eOpcode::opcode_2NNN;
+            case 0x03:
+                return eOpcode::opcode_3XNN;
+            case 0x04:
+                return eOpcode::opcode_4XNN;
+            case 0x05:
+                return eOpcode::opcode_5XY0;
+            case 0x06:
+                return eOpcode::opcode_6XNN;
+            case 0x07:
+                return eOpcode::opcode_7XNN;
+            case 0x08:
+            {
+                switch (nibble4)
+                {
+                    case 0x00:
+                        return eOpcode::opcode_8XY0;
+                    case 0x01:
+                        return eOpcode::opcode_8XY1;
+                    case 0x02:
+                        return eOpcode::opcode_8XY2;
+                    case 0x03:
+                        return eOpcode::opcode_8XY3;
+                    case 0x04:
+                        return eOpcode::opcode_8XY4;
+                    case 0x05:
+                        return eOpcode::opcode_8XY5;
+                    case 0x06:
+                        return eOpcode::opcode_8XY6;
+                    case 0x07:
+                        return eOpcode::opcode_8XY7;
+                    case 0x0E:
+                        return eOpcode::opcode_8XYE;
+                    default:
+                        return eOpcode::invalid;
+                }
+            }
+            case 0x09:
+                return eOpcode::opcode_9XY0;
+            case 0x0A:
+                return eOpcode::opcode_ANNN;
+            case 0x0B:
+                return eOpcode::opcode_BNNN;
+            case 0x0C:
+                return eOpcode::opcode_CXNN;
+            case 0x0D:
+                return eOpcode::opcode_DXYN;
+            case 0x0E:
+            {
+                if (nibble3 == 0x9 && nibble4 == 0xE)
+                {
+                    return eOpcode::opcode_EX9E;
+                }
+
+                if (nibble3 == 0xA && nibble4 == 0x1)
+                {
+                    return eOpcode::opcode_EXA1;
+                }
+
+                return eOpcode::invalid;
+            }
+            case 0x0F:
+            {
+                uint8_t low_byte = opcode & 0x00FF;
+                switch (low_byte)
+                {
+                    case 0x07:
+                        return eOpcode::opcode_FX07;
+                    case 0x0A:
+                        return eOpcode::opcode_FX0A;
+                    case 0x15:
+                        return eOpcode::opcode_FX15;
+                    case 0x18:
+                        return eOpcode::opcode_FX18;
+                    case 0x1E:
+                        return eOpcode::opcode_FX1E;
+                    case 0x29:
+                        return eOpcode::opcode_FX29;
+                    case 0x33:
+                        return eOpcode::opcode_FX33;
+                    case 0x55:
+                        return eOpcode::opcode_FX55;
+                    case 0x65:
+                        return eOpcode::opcode_FX65;
+                    default:
+                        return eOpcode::invalid;
+                }
+            }
+            default:
+                return eOpcode::invalid;
+        }
+    }
+
+    const char* get_opcode_name(eOpcode type)
+    {
+        switch (type)
+        {
+            case eOpcode::opcode_0E00:
+                return "0E00";
+            case eOpcode::opcode_00EE:
+                return "00EE";
+            case eOpcode::opcode_1NNN:
+                return "1NNN";
+            case eOpcode::opcode_2NNN:
+                return "2NNN";
+            case eOpcode::opcode_3XNN:
+                return "3XNN";
+            case eOpcode::opcode_4XNN:
+                return "4XNN";
+            case eOpcode::opcode_5XY0:
+                return "5XY0";
+            case eOpcode::opcode_6XNN:
+                return "6XNN";
+            case eOpcode::opcode_7XNN:
+                return "7XNN";
+            case eOpcode::opcode_8XY0:
+                return "8XY0";
+            case eOpcode::opcode_8XY1:
+                return "8XY1";
+            case eOpcode::opcode_8XY2:
+                return "8XY2";
+            case eOpcode::opcode_8XY3:
+                return "8XY3";
+            case eOpcode::opcode_8XY4:
+                return "8XY4";
+            case eOpcode::opcode_8XY5:
+                return "8XY5";
+            case eOpcode::opcode_8XY6:
+                return "8XY6";
+            case eOpcode::opcode_8XY7:
+                return "8XY7";
+            case eOpcode::opcode_8XYE:
+                return "8XYE";
+            case eOpcode::opcode_9XY0:
+                return "9XY0";
+            case eOpcode::opcode_ANNN:
+                return "ANNN";
+            case eOpcode::opcode_BNNN:
+                return "BNNN";
+            case eOpcode::opcode_CXNN:
+                return "CXNN";
+            case eOpcode::opcode_DXYN:
+                return "DXYN";
+            case eOpcode::opcode_EX9E:
+                return "EX9E";
+            case eOpcode::opcode_EXA1:
+                return "EXA1";
+            case eOpcode::opcode_FX07:
+                return "FX07";
+            case eOpcode::opcode_FX0A:
+                return "FX0A";
+            case eOpcode::opcode_FX15:
+                return "FX15";
+            case eOpcode::opcode_FX18:
+                return "FX18";
+            case eOpcode::opcode_FX1E:
+                return "FX1E";
+            case eOpcode::opcode_FX29:
+                return "FX29";
+            case eOpcode::opcode_FX33:
+                return "FX33";
+            case eOpcode::opcode_FX55:
+                return "FX55";
+            case eOpcode::opcode_FX65:
+                return "FX65";
+            default:
+                return "????";
+        }
+    }
+
+    int32_t disassemble_instruction(uint16_t opcode, char* buffer, int32_t size)
+    {
+        sInstruction instruction = decode_instruction(opcode);
+
+        switch (classify_opcode(opcode))
+        {
+            case eOpcode::opcode_0E00:
+                return std::snprintf(buffer, size, "CLS");
+            case eOpcode::opcode_00EE:
+                return std::snprintf(buffer, size, "RET");
+            case eOpcode::opcode_1NNN:
+                return std::snprintf(buffer, size, "JP 0x%03X", instruction.nnn);
+            case eOpcode::opcode_2NNN:
+                return std::snprintf(buffer, size, "CALL 0x%03X", instruction.nnn);
+            case eOpcode::opcode_3XNN:
+                return std::snprintf(buffer, size, "SE V%X, 0x%02X", instruction.x, instruction.nn);
+            case eOpcode::opcode_4XNN:
+                return std::snprintf(buffer, size, "SNE V%X, 0x%02X", instruction.x, instruction.nn);
+            case eOpcode::opcode_5XY0:
+                return std::snprintf(buffer, size, "SE V%X, V%X", instruction.x, instruction.y);
+            case eOpcode::opcode_6XNN:
+                return std::snprintf(buffer, size, "LD V%X, 0x%02X", instruction.x, instruction.nn);
+            case eOpcode::opcode_7XNN:
+                return std::snprintf(buffer, size, "ADD V%X, 0x%02X", instruction.x, instruction.nn);
+            case eOpcode::opcode_8XY0:
+                return std::snprintf(buffer, size, "LD V%X, V%X", instruction.x, instruction.y);
+            case eOpcode::opcode_8XY1:
+                return std::snprintf(buffer, size, "OR V%X, V%X", instruction.x, instruction.y);
+            case eOpcode::opcode_8XY2:
+                return std::snprintf(buffer, size, "AND V%X, V%X", instruction.x, instruction.y);
+            case eOpcode::opcode_8XY3:
+                return std::snprintf(buffer, size, "XOR V%X, V%X", instruction.x, instruction.y);
+            case eOpcode::opcode_8XY4:
+                return std::snprintf(buffer, size, "ADD V%X, V%X", instruction.x, instruction.y);
+            case eOpcode::opcode_8XY5:
+                return std::snprintf(buffer, size, "SUB V%X, V%X", instruction.x, instruction.y);
+            case eOpcode::opcode_8XY6:
+                return std::snprintf(buffer, size, "SHR V%X, V%X", instruction.x, instruction.y);
+            case eOpcode::opcode_8XY7:
+                return std::snprintf(buffer, size, "SUBN V%X, V%X", instruction.x, instruction.y);
+            case eOpcode::opcode_8XYE:
+                return std::snprintf(buffer, size, "SHL V%X, V%X", instruction.x, instruction.y);
+            case eOpcode::opcode_9XY0:
+                return std::snprintf(buffer, size, "SNE V%X, V%X", instruction.x, instruction.y);
+            case eOpcode::opcode_ANNN:
+                return std::snprintf(buffer, size, "LD I, 0x%03X", instruction.nnn);
+            case eOpcode::opcode_BNNN:
+                return std::snprintf(buffer, size, "JP V0, 0x%03X", instruction.nnn);
+            case eOpcode::opcode_CXNN:
+                return std::snprintf(buffer, size, "RND V%X, 0x%02X", instruction.x, instruction.nn);
+            case eOpcode::opcode_DXYN:
+                return std::snprintf(buffer, size, "DRW V%X, V%X, %d", instruction.x, instruction.y, instruction.n);
+            case eOpcode::opcode_EX9E:
+                return std::snprintf(buffer, size, "SKP V%X", instruction.x);
+            case eOpcode::opcode_EXA1:
+                return std::snprintf(buffer, size, "SKNP V%X", instruction.x);
+            case eOpcode::opcode_FX07:
+                return std::snprintf(buffer, size, "LD V%X, DT", instruction.x);
+            case eOpcode::opcode_FX0A:
+                return std::snprintf(buffer, size, "LD V%X, K", instruction.x);
+            case eOpcode::opcode_FX15:
+                return std::snprintf(buffer, size, "LD DT, V%X", instruction.x);
+            case eOpcode::opcode_FX18:
+                return std::snprintf(buffer, size, "LD ST, V%X", instruction.x);
+            case eOpcode::opcode_FX1E:
+                return std::snprintf(buffer, size, "ADD I, V%X", instruction.x);
+            case eOpcode::opcode_FX29:
+                return std::snprintf(buffer, size, "LD F, V%X", instruction.x);
+            case eOpcode::opcode_FX33:
+                return std::snprintf(buffer, size, "LD B, V%X", instruction.x);
+            case eOpcode::opcode_FX55:
+                return std::snprintf(buffer, size, "LD [I], V%X", instruction.x);
+            case eOpcode::opcode_FX65:
+                return std::snprintf(buffer, size, "LD V%X, [I]", instruction.x);
+            default:
+                return std::snprintf(buffer, size, "DW 0x%04X", opcode);
+        }
+    }
+}
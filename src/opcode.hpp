@@ -0,0 +1,86 @@
+#ifndef CHIP8_SRC_OPCODEHPP
+#define CHIP8_SRC_OPCODEHPP
+
+#include <cstdint>
+
+namespace chip8
+{
+    // Every instruction the processor knows how to execute.
+    // Used by the table driven decoders to index handlers with a single lookup.
+    enum class eOpcode : uint8_t
+    {
+        invalid = 0,
+        opcode_0E00,
+        opcode_00EE,
+        opcode_1NNN,
+        opcode_2NNN,
+        opcode_3XNN,
+        opcode_4XNN,
+        opcode_5XY0,
+        opcode_6XNN,
+        opcode_7XNN,
+        opcode_8XY0,
+        opcode_8XY1,
+        opcode_8XY2,
+        opcode_8XY3,
+        opcode_8XY4,
+        opcode_8XY5,
+        opcode_8XY6,
+        opcode_8XY7,
+        opcode_8XYE,
+        opcode_9XY0,
+        opcode_ANNN,
+        opcode_BNNN,
+        opcode_CXNN,
+        opcode_DXYN,
+        opcode_EX9E,
+        opcode_EXA1,
+        opcode_FX07,
+        opcode_FX0A,
+        opcode_FX15,
+        opcode_FX18,
+        opcode_FX1E,
+        opcode_FX29,
+        opcode_FX33,
+        opcode_FX55,
+        opcode_FX65,
+        count,
+    };
+
+    constexpr int32_t OPCODE_COUNT = static_cast<int32_t>(eOpcode::count);
+
+    // Operands of an instruction, extracted once so that handlers do not have to.
+    // Opcode = Nibble 1234. X = Nibble 2, Y = Nibble 3, N = Nibble 4, NN = Nibbles 34, NNN = Nibbles 234.
+    struct sInstruction
+    {
+        uint16_t opcode;
+        uint16_t nnn;
+        uint8_t  x;
+        uint8_t  y;
+        uint8_t  n;
+        uint8_t  nn;
+    };
+
+    // Decodes a raw opcode following exactly the same rules as cProcessor's switch decoder.
+    eOpcode classify_opcode(uint16_t opcode);
+
+    // Pattern name of the instruction, like "8XY4".
+    const char* get_opcode_name(eOpcode type);
+
+    // Writes the instruction in the usual assembler notation, like "ADD V1, V2". Same return value as snprintf.
+    int32_t disassemble_instruction(uint16_t opcode, char* buffer, int32_t size);
+
+    inline sInstruction decode_instruction(uint16_t opcode)
+    {
+        sInstruction instruction;
+        instruction.opcode = opcode;
+        instruction.nnn = opcode & 0x0FFF;
+        instruction.x = (opcode >> 8) & 0x0F;
+        instruction.y = (opcode >> 4) & 0x0F;
+        instruction.n = opcode & 0x0F;
+        instruction.nn = opcode & 0xFF;
+        return instruction;
+    }
+}
+
+#endif // CHIP8_SRC_OPCODEHPP
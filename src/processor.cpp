@@ -3,209 +3,1276 @@
 #include "display.hpp"
 #include "keyboard.hpp"
 #include "log.hpp"
+#include "machine_state.hpp"
 #include "ram.hpp"
 #include "timer.hpp"
+#include "trace.hpp"
 
 #include <assert.h>
+
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 
 namespace chip8
 {
-    cProcessor::cProcessor(int32_t program_start_location, int32_t register_count)
+    namespace
+    {
+        // Eight registers as a word, the lowest numbered in the least significant byte whatever the host.
+        uint64_t load_register_word(const uint8_t* registers)
+        {
+            uint64_t word;
+            std::memcpy(&word, registers, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            word = __builtin_bswap64(word);
+#endif
+            return word;
+        }
+
+        // Bit i is set when byte i of the words differs. Folds every byte onto its lowest bit, then gathers those
+        // bits into the top byte with a multiply, so there are no branches.
+        uint16_t get_changed_bytes(uint64_t before, uint64_t after)
+        {
+            uint64_t difference = before ^ after;
+            difference |= difference >> 4;
+            difference |= difference >> 2;
+            difference |= difference >> 1;
+            difference &= 0x0101010101010101ULL;
+            return static_cast<uint16_t>((difference * 0x0102040810204080ULL) >> 56);
+        }
+
+        // Instructions that may leave the program counter somewhere other than the next instruction.
+        bool ends_block(eOpcode type)
+        {
+            switch (type)
+            {
+                case eOpcode::invalid:
+                case eOpcode::opcode_00EE:
+                case eOpcode::opcode_1NNN:
+                case eOpcode::opcode_2NNN:
+                case eOpcode::opcode_3XNN:
+                case eOpcode::opcode_4XNN:
+                case eOpcode::opcode_5XY0:
+                case eOpcode::opcode_9XY0:
+                case eOpcode::opcode_BNNN:
+                case eOpcode::opcode_DXYN:
+                case eOpcode::opcode_EX9E:
+                case eOpcode::opcode_EXA1:
+                case eOpcode::opcode_FX0A:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        // Threaded interpreter op kinds. The first OPCODE_COUNT values match eOpcode.
+        enum eThreadedKind : uint8_t
+        {
+            threaded_invalid = 0,
+            threaded_0E00,
+            threaded_00EE,
+            threaded_1NNN,
+            threaded_2NNN,
+            threaded_3XNN,
+            threaded_4XNN,
+            threaded_5XY0,
+            threaded_6XNN,
+            threaded_7XNN,
+            threaded_8XY0,
+            threaded_8XY1,
+            threaded_8XY2,
+            threaded_8XY3,
+            threaded_8XY4,
+            threaded_8XY5,
+            threaded_8XY6,
+            threaded_8XY7,
+            threaded_8XYE,
+            threaded_9XY0,
+            threaded_ANNN,
+            threaded_BNNN,
+            threaded_CXNN,
+            threaded_DXYN,
+            threaded_EX9E,
+            threaded_EXA1,
+            threaded_FX07,
+            threaded_FX0A,
+            threaded_FX15,
+            threaded_FX18,
+            threaded_FX1E,
+            threaded_FX29,
+            threaded_FX33,
+            threaded_FX55,
+            threaded_FX65,
+            // Superinstructions. Picked from --profile-pairs runs over our ROMs.
+            threaded_6XNN_6XNN, // Sprite coordinates.
+            threaded_6XNN_ANNN, // Sprite setup before DXYN.
+            threaded_ANNN_DXYN, // Sprite draw.
+            threaded_7XNN_3XNN, // Loop counters.
+            threaded_ANNN_FX65, // Table loads.
+            threaded_kind_count,
+        };
+
+        static_assert(threaded_FX65 + 1 == OPCODE_COUNT, "Threaded kinds must start with every eOpcode");
+
+        struct sFusion
+        {
+            eOpcode       first;
+            eOpcode       second;
+            eThreadedKind kind;
+        };
+
+        constexpr sFusion FUSIONS[] = {
+            {eOpcode::opcode_6XNN, eOpcode::opcode_6XNN, threaded_6XNN_6XNN},
+            {eOpcode::opcode_6XNN, eOpcode::opcode_ANNN, threaded_6XNN_ANNN},
+            {eOpcode::opcode_ANNN, eOpcode::opcode_DXYN, threaded_ANNN_DXYN},
+            {eOpcode::opcode_7XNN, eOpcode::opcode_3XNN, threaded_7XNN_3XNN},
+            {eOpcode::opcode_ANNN, eOpcode::opcode_FX65, threaded_ANNN_FX65},
+        };
+    }
+
+// Labels as values are a GCC/Clang extension. Define CHIP8_NO_COMPUTED_GOTO to test the portable switch.
+#if defined(__GNUC__) && !defined(CHIP8_NO_COMPUTED_GOTO)
+#define CHIP8_THREADED_GOTO 1
+#else
+#define CHIP8_THREADED_GOTO 0
+#endif
+
+    cProcessor::cProcessor(sMachineState* state, int32_t program_start_location)
+    {
+        _register_count = REGISTER_COUNT;
+        init(state, program_start_location);
+    }
+
+    void cProcessor::init(sMachineState* state, int32_t program_start_location)
+    {
+        _state = state;
+        _state->program_counter = static_cast<uint16_t>(program_start_location);
+        _dispatch_table = &get_dispatch_table();
+    }
+
+    cProcessor::~cProcessor()
     {
-        _registers = std::vector<uint8_t>(register_count, 0U);
-        _register_i = 0U;
-        _program_counter = static_cast<int16_t>(program_start_location);
+        if (_attached_ram != nullptr)
+        {
+            _attached_ram->remove_write_listener(_ram_listener);
+        }
     }
 
     void cProcessor::execute_next_instruction(cRam* ram, cDisplay* display, cKeyboard* keyboard, cTimer* delay_timer, cTimer* sound_timer)
     {
-        assert(_program_counter < ram->size() - 1);
-        uint16_t instr_first_half = static_cast<uint16_t>(ram->read(_program_counter));
-        uint16_t instr_second_half = static_cast<uint16_t>(ram->read(_program_counter + 1));
+        assert(_state->program_counter < ram->size() - 1);
 
-        uint16_t opcode = (instr_first_half << 8) | instr_second_half;
+        thoth::info("Executing instruction %04x at program counter=%d\n", fetch_opcode(ram), _state->program_counter);
 
-        // Opcode = Nibble 1234
-        uint8_t nibble1 = (opcode >> 12) & 0x000F;
+        run_cycles(1, ram, display, keyboard, delay_timer, sound_timer);
+    }
+
+    int32_t cProcessor::run_cycles(int32_t cycles, cRam* ram, cDisplay* display, cKeyboard* keyboard, cTimer* delay_timer, cTimer* sound_timer)
+    {
+        const sPeripherals peripherals {ram, display, keyboard, delay_timer, sound_timer};
+
+        // Key state only changes between runs, so EX9E and EXA1 are plain bit tests.
+        keyboard->poll_events();
+
+        if (_state->waiting_for_key && !resume_key_wait(keyboard))
+        {
+            if (_trace != nullptr)
+            {
+                _trace->skip_cycles(cycles);
+            }
+
+            return 0;
+        }
+
+        if (ram != _attached_ram)
+        {
+            attach_ram(ram);
+        }
+
+        if (_trace != nullptr)
+        {
+            return run_traced(cycles, peripherals);
+        }
+
+        if (_profile_pairs)
+        {
+            return run_pair_profiling(cycles, peripherals);
+        }
+
+        // FX0A halts the processor in the middle of a run, so the plain loops check for it after every instruction.
+        int32_t executed = 0;
+
+        switch (_dispatch_mode)
+        {
+            case eDispatchMode::switch_decoder:
+            {
+                for (; executed < cycles && !_state->waiting_for_key; executed++)
+                {
+                    assert(_state->program_counter < ram->size() - 1);
+                    sInstruction instruction = decode_instruction(fetch_opcode(ram));
+                    _state->program_counter += 2;
+                    execute_decoded_switch(instruction, peripherals);
+                }
+            }
+            break;
+            case eDispatchMode::table:
+            {
+                for (; executed < cycles && !_state->waiting_for_key; executed++)
+                {
+                    assert(_state->program_counter < ram->size() - 1);
+                    sInstruction instruction = decode_instruction(fetch_opcode(ram));
+                    _state->program_counter += 2;
+                    execute_decoded_table(instruction, peripherals);
+                }
+            }
+            break;
+            case eDispatchMode::decode_cache:
+            {
+                for (; executed < cycles && !_state->waiting_for_key; executed++)
+                {
+                    assert(_state->program_counter < ram->size() - 1);
+                    const sCachedInstruction& cached = get_cached_instruction(ram);
+                    _state->program_counter += 2;
+                    _dispatch_table->handlers[cached.handler_index](this, cached.instruction, peripherals);
+                }
+            }
+            break;
+            case eDispatchMode::block:
+            {
+                return run_blocks(cycles, peripherals);
+            }
+            case eDispatchMode::jit:
+            {
+                return run_jit(cycles, peripherals);
+            }
+            case eDispatchMode::threaded:
+            {
+                return run_threaded(cycles, peripherals);
+            }
+        }
+
+        return executed;
+    }
+
+    int32_t cProcessor::skip_idle_loop(int32_t cycles, cRam* ram, cDisplay* display, cKeyboard* keyboard, cTimer* delay_timer, cTimer* sound_timer)
+    {
+        if (_state->waiting_for_key || _trace != nullptr)
+        {
+            return 0;
+        }
+
+        int32_t executed = 0;
+
+        // Inside a delay loop, run up to its FX07 so that every skipped iteration is a whole one.
+        for (int32_t offset = 2; offset <= 4; offset += 2)
+        {
+            int32_t head = _state->program_counter - offset;
+            int32_t steps = (6 - offset) / 2;
+
+            if (head >= 0 && is_delay_wait_loop(head, ram) && steps < cycles)
+            {
+                executed = run_cycles(steps, ram, display, keyboard, delay_timer, sound_timer);
+                break;
+            }
+        }
+
+        if (!is_delay_wait_loop(_state->program_counter, ram))
+        {
+            return executed;
+        }
+
+        // The timer only changes between batches, so every iteration until then takes the same branch.
+        sInstruction read_timer = decode_instruction(fetch_opcode(ram));
+        sInstruction compare = decode_instruction((static_cast<uint16_t>(ram->read(_state->program_counter + 2)) << 8) | ram->read(_state->program_counter + 3));
+        uint8_t      time = delay_timer->get_time();
+        bool         keeps_waiting = classify_opcode(compare.opcode) == eOpcode::opcode_3XNN ? time != compare.nn : time == compare.nn;
+
+        int32_t iterations = keeps_waiting ? (cycles - executed) / 3 : 0;
+        if (iterations > 0)
+        {
+            _state->registers[read_timer.x] = time;
+            executed += iterations * 3;
+        }
+
+        return executed;
+    }
+
+    bool cProcessor::is_waiting_for_key() const
+    {
+        return _state->waiting_for_key != 0U;
+    }
+
+    bool cProcessor::resume_key_wait(cKeyboard* keyboard)
+    {
+        int8_t pressed_key = keyboard->await_key_press();
+
+        if (pressed_key == -1)
+        {
+            return false;
+        }
+
+        _state->registers[_state->key_register] = static_cast<uint8_t>(pressed_key);
+        _state->waiting_for_key = 0U;
+        return true;
+    }
+
+    bool cProcessor::is_delay_wait_loop(int32_t address, cRam* ram) const
+    {
+        if (address + 5 >= ram->size())
+        {
+            return false;
+        }
+
+        sInstruction instructions[3];
+        eOpcode      types[3];
+        for (int32_t i = 0; i < 3; i++)
+        {
+            uint16_t opcode = (static_cast<uint16_t>(ram->read(address + 2 * i)) << 8) | ram->read(address + 2 * i + 1);
+            instructions[i] = decode_instruction(opcode);
+            types[i] = static_cast<eOpcode>(_dispatch_table->handler_index[opcode]);
+        }
+
+        return types[0] == eOpcode::opcode_FX07 && (types[1] == eOpcode::opcode_3XNN || types[1] == eOpcode::opcode_4XNN) && instructions[1].x == instructions[0].x &&
+               types[2] == eOpcode::opcode_1NNN && instructions[2].nnn == address;
+    }
+
+    void cProcessor::set_dispatch_mode(eDispatchMode mode)
+    {
+        _dispatch_mode = mode;
+
+        if (_dispatch_mode == eDispatchMode::jit && _jit == nullptr)
+        {
+            _jit = std::make_unique<cJitCompiler>();
+        }
+
+        // Blocks translated for one mode may lack (or carry stale) native code for another.
+        reset_caches();
+    }
+
+    cProcessor::eDispatchMode cProcessor::get_dispatch_mode() const
+    {
+        return _dispatch_mode;
+    }
+
+    uint8_t cProcessor::get_register(int32_t index) const
+    {
+        assert(index < _register_count);
+        return _state->registers[index];
+    }
+
+    void cProcessor::set_register(int32_t index, uint8_t value)
+    {
+        assert(index < _register_count);
+        _state->registers[index] = value;
+    }
+
+    uint16_t cProcessor::get_register_i() const
+    {
+        return _state->register_i;
+    }
+
+    void cProcessor::set_register_i(uint16_t value)
+    {
+        _state->register_i = value;
+    }
+
+    uint16_t cProcessor::get_program_counter() const
+    {
+        return _state->program_counter;
+    }
+
+    void cProcessor::set_program_counter(uint16_t value)
+    {
+        _state->program_counter = value;
+    }
+
+    void cProcessor::set_random_seed(uint64_t seed)
+    {
+        _state->random_seed = seed;
+        _state->random_state = cRandom::get_seeded_state(seed);
+    }
+
+    uint64_t cProcessor::get_random_seed() const
+    {
+        return _state->random_seed;
+    }
+
+    uint64_t cProcessor::get_random_state() const
+    {
+        return _state->random_state;
+    }
+
+    void cProcessor::set_random_state(uint64_t state)
+    {
+        _state->random_state = state;
+    }
+
+    const cProcessor::sDispatchTable& cProcessor::get_dispatch_table()
+    {
+        static const sDispatchTable table = []()
+        {
+            sDispatchTable result {};
+
+            result.handlers[static_cast<size_t>(eOpcode::invalid)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_invalid(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_0E00)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals& io)
+            { p->execute_opcode_0E00(instruction, io.display); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_00EE)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals& io)
+            { p->execute_opcode_00EE(instruction, io.ram); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_1NNN)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_1NNN(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_2NNN)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals& io)
+            { p->execute_opcode_2NNN(instruction, io.ram); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_3XNN)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_3XNN(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_4XNN)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_4XNN(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_5XY0)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_5XY0(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_6XNN)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_6XNN(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_7XNN)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_7XNN(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_8XY0)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_8XY0(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_8XY1)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_8XY1(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_8XY2)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_8XY2(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_8XY3)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_8XY3(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_8XY4)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_8XY4(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_8XY5)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_8XY5(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_8XY6)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_8XY6(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_8XY7)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_8XY7(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_8XYE)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_8XYE(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_9XY0)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_9XY0(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_ANNN)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_ANNN(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_BNNN)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_BNNN(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_CXNN)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_CXNN(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_DXYN)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals& io)
+            { p->execute_opcode_DXYN(instruction, io.ram, io.display); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_EX9E)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals& io)
+            { p->execute_opcode_EX9E(instruction, io.keyboard); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_EXA1)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals& io)
+            { p->execute_opcode_EXA1(instruction, io.keyboard); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_FX07)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals& io)
+            { p->execute_opcode_FX07(instruction, io.delay_timer); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_FX0A)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals& io)
+            { p->execute_opcode_FX0A(instruction, io.keyboard); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_FX15)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals& io)
+            { p->execute_opcode_FX15(instruction, io.delay_timer); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_FX18)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals& io)
+            { p->execute_opcode_FX18(instruction, io.sound_timer); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_FX1E)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals&)
+            { p->execute_opcode_FX1E(instruction); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_FX29)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals& io)
+            { p->execute_opcode_FX29(instruction, io.ram); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_FX33)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals& io)
+            { p->execute_opcode_FX33(instruction, io.ram); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_FX55)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals& io)
+            { p->execute_opcode_FX55(instruction, io.ram); };
+            result.handlers[static_cast<size_t>(eOpcode::opcode_FX65)] = [](cProcessor* p, const sInstruction& instruction, const sPeripherals& io)
+            { p->execute_opcode_FX65(instruction, io.ram); };
+
+            for (uint32_t opcode = 0U; opcode < result.handler_index.size(); opcode++)
+            {
+                result.handler_index[opcode] = static_cast<uint8_t>(classify_opcode(static_cast<uint16_t>(opcode)));
+            }
+
+            return result;
+        }();
+
+        return table;
+    }
+
+    uint16_t cProcessor::fetch_opcode(cRam* ram)
+    {
+        uint16_t instr_first_half = static_cast<uint16_t>(ram->read(_state->program_counter));
+        uint16_t instr_second_half = static_cast<uint16_t>(ram->read(_state->program_counter + 1));
+
+        return (instr_first_half << 8) | instr_second_half;
+    }
+
+    const cProcessor::sCachedInstruction& cProcessor::get_cached_instruction(cRam* ram)
+    {
+        sCachedInstruction& cached = _instruction_cache[_state->program_counter];
+
+        if (!cached.valid)
+        {
+            uint16_t opcode = fetch_opcode(ram);
+            cached.instruction = decode_instruction(opcode);
+            cached.handler_index = _dispatch_table->handler_index[opcode];
+            cached.valid = true;
+        }
+
+        return cached;
+    }
+
+    void cProcessor::attach_ram(cRam* ram)
+    {
+        // Only the attached ram keeps a listener, so switching back and forth does not pile them up.
+        if (_attached_ram != nullptr)
+        {
+            _attached_ram->remove_write_listener(_ram_listener);
+        }
+
+        _attached_ram = ram;
+        reset_caches();
+
+        // FX33 and FX55 can overwrite code. Anything decoded from the touched bytes must be decoded again.
+        _ram_listener = ram->add_write_listener([this](int32_t index, int32_t length) { on_ram_write(index, length); });
+    }
+
+    void cProcessor::reset_caches()
+    {
+        if (_attached_ram == nullptr)
+        {
+            return;
+        }
+
+        _instruction_cache.assign(_attached_ram->size(), sCachedInstruction {});
+        _blocks = std::vector<sBlock>(_attached_ram->size());
+        _block_code.assign(_attached_ram->size(), false);
+        _threaded_ops.assign(_attached_ram->size(), sThreadedOp {});
+
+        if (_jit != nullptr)
+        {
+            _jit->reset();
+        }
+    }
+
+    void cProcessor::on_ram_write(int32_t index, int32_t length)
+    {
+        invalidate_instruction_cache(index, length);
+        invalidate_blocks(index, length);
+        invalidate_threaded_ops(index, length);
+    }
+
+    void cProcessor::invalidate_instruction_cache(int32_t index, int32_t length)
+    {
+        // An instruction starting one byte before the write also covers the written byte.
+        int32_t first = std::max(0, index - 1);
+        int32_t last = std::min(static_cast<int32_t>(_instruction_cache.size()), index + length);
+
+        for (int32_t i = first; i < last; i++)
+        {
+            _instruction_cache[i].valid = false;
+        }
+    }
+
+    const cProcessor::sThreadedOp& cProcessor::get_threaded_op(cRam* ram)
+    {
+        assert(_state->program_counter < ram->size() - 1);
+        sThreadedOp& op = _threaded_ops[_state->program_counter];
+
+        if (!op.valid)
+        {
+            decode_threaded_op(_state->program_counter, ram);
+        }
+
+        return op;
+    }
+
+    void cProcessor::decode_threaded_op(uint16_t address, cRam* ram)
+    {
+        sThreadedOp& op = _threaded_ops[address];
+
+        uint16_t opcode = (static_cast<uint16_t>(ram->read(address)) << 8) | ram->read(address + 1);
+        eOpcode  type = static_cast<eOpcode>(_dispatch_table->handler_index[opcode]);
+
+        op.instruction = decode_instruction(opcode);
+        op.kind = static_cast<uint8_t>(type);
+        op.single_kind = op.kind;
+        op.valid = true;
+
+        if (address + 3 >= ram->size())
+        {
+            return;
+        }
+
+        uint16_t next_opcode = (static_cast<uint16_t>(ram->read(address + 2)) << 8) | ram->read(address + 3);
+        eOpcode  next_type = static_cast<eOpcode>(_dispatch_table->handler_index[next_opcode]);
+
+        for (const sFusion& fusion : FUSIONS)
+        {
+            if (fusion.first == type && fusion.second == next_type)
+            {
+                // The fused op reads the second instruction from the next slot, so it must be decoded too.
+                if (!_threaded_ops[address + 2].valid)
+                {
+                    decode_threaded_op(address + 2, ram);
+                }
+
+                op.kind = fusion.kind;
+                break;
+            }
+        }
+    }
+
+    void cProcessor::invalidate_threaded_ops(int32_t index, int32_t length)
+    {
+        // A fused slot covers four bytes, so it starts up to three bytes before the write.
+        int32_t first = std::max(0, index - 3);
+        int32_t last = std::min(static_cast<int32_t>(_threaded_ops.size()), index + length);
+
+        for (int32_t i = first; i < last; i++)
+        {
+            _threaded_ops[i].valid = false;
+        }
+    }
+
+    int32_t cProcessor::run_threaded(int32_t cycles, const sPeripherals& peripherals)
+    {
+        cRam*      ram = peripherals.ram;
+        cDisplay*  display = peripherals.display;
+        cKeyboard* keyboard = peripherals.keyboard;
+        cTimer*    delay_timer = peripherals.delay_timer;
+        cTimer*    sound_timer = peripherals.sound_timer;
 
-        thoth::info("Executing instruction %04x at program counter=%d\n", opcode, _program_counter);
+        int32_t            executed = 0;
+        const sThreadedOp* op = nullptr;
+        const sThreadedOp* next = nullptr;
+
+#if CHIP8_THREADED_GOTO
+        static void* const labels[threaded_kind_count] = {
+            &&label_threaded_invalid, &&label_threaded_0E00,      &&label_threaded_00EE,      &&label_threaded_1NNN,      &&label_threaded_2NNN,
+            &&label_threaded_3XNN,    &&label_threaded_4XNN,      &&label_threaded_5XY0,      &&label_threaded_6XNN,      &&label_threaded_7XNN,
+            &&label_threaded_8XY0,    &&label_threaded_8XY1,      &&label_threaded_8XY2,      &&label_threaded_8XY3,      &&label_threaded_8XY4,
+            &&label_threaded_8XY5,    &&label_threaded_8XY6,      &&label_threaded_8XY7,      &&label_threaded_8XYE,      &&label_threaded_9XY0,
+            &&label_threaded_ANNN,    &&label_threaded_BNNN,      &&label_threaded_CXNN,      &&label_threaded_DXYN,      &&label_threaded_EX9E,
+            &&label_threaded_EXA1,    &&label_threaded_FX07,      &&label_threaded_FX0A,      &&label_threaded_FX15,      &&label_threaded_FX18,
+            &&label_threaded_FX1E,    &&label_threaded_FX29,      &&label_threaded_FX33,      &&label_threaded_FX55,      &&label_threaded_FX65,
+            &&label_threaded_6XNN_6XNN, &&label_threaded_6XNN_ANNN, &&label_threaded_ANNN_DXYN, &&label_threaded_7XNN_3XNN, &&label_threaded_ANNN_FX65,
+        };
+
+#define THREADED_CASE(kind) label_##kind
+#define THREADED_DISPATCH()              \
+    if (executed >= cycles)             \
+    {                                   \
+        goto threaded_done;             \
+    }                                   \
+    op = &get_threaded_op(ram);         \
+    goto* labels[op->kind]
+#define THREADED_SINGLE(kind) goto* labels[op->single_kind]
+
+        THREADED_DISPATCH();
+#else
+#define THREADED_CASE(kind) case kind
+#define THREADED_DISPATCH() continue
+#define THREADED_SINGLE(kind) \
+    kind_override = op->single_kind; \
+    goto threaded_switch
+
+        uint8_t kind_override = 0U;
+        while (executed < cycles)
+        {
+            op = &get_threaded_op(ram);
+            kind_override = op->kind;
+        threaded_switch:
+            switch (kind_override)
+            {
+#endif
+
+// Runs one ordinary instruction and dispatches the next.
+#define THREADED_OP(kind, call)  \
+    THREADED_CASE(kind) :        \
+    {                            \
+        _state->program_counter += 2;   \
+        executed++;              \
+        call;                    \
+    }                            \
+    THREADED_DISPATCH();
+
+// Runs two adjacent instructions with a single dispatch. The second one's operands live in the next slot.
+#define THREADED_FUSED(kind, first_call, second_call) \
+    THREADED_CASE(kind) :                             \
+    {                                                 \
+        if (cycles - executed < 2)                    \
+        {                                             \
+            THREADED_SINGLE(kind);                    \
+        }                                             \
+        next = &_threaded_ops[_state->program_counter + 2];  \
+        _state->program_counter += 2;                        \
+        first_call;                                   \
+        _state->program_counter += 2;                        \
+        second_call;                                  \
+        executed += 2;                                \
+    }                                                 \
+    THREADED_DISPATCH();
+
+        THREADED_OP(threaded_invalid, execute_opcode_invalid(op->instruction))
+        THREADED_OP(threaded_0E00, execute_opcode_0E00(op->instruction, display))
+        THREADED_OP(threaded_00EE, execute_opcode_00EE(op->instruction, ram))
+        THREADED_OP(threaded_1NNN, execute_opcode_1NNN(op->instruction))
+        THREADED_OP(threaded_2NNN, execute_opcode_2NNN(op->instruction, ram))
+        THREADED_OP(threaded_3XNN, execute_opcode_3XNN(op->instruction))
+        THREADED_OP(threaded_4XNN, execute_opcode_4XNN(op->instruction))
+        THREADED_OP(threaded_5XY0, execute_opcode_5XY0(op->instruction))
+        THREADED_OP(threaded_6XNN, execute_opcode_6XNN(op->instruction))
+        THREADED_OP(threaded_7XNN, execute_opcode_7XNN(op->instruction))
+        THREADED_OP(threaded_8XY0, execute_opcode_8XY0(op->instruction))
+        THREADED_OP(threaded_8XY1, execute_opcode_8XY1(op->instruction))
+        THREADED_OP(threaded_8XY2, execute_opcode_8XY2(op->instruction))
+        THREADED_OP(threaded_8XY3, execute_opcode_8XY3(op->instruction))
+        THREADED_OP(threaded_8XY4, execute_opcode_8XY4(op->instruction))
+        THREADED_OP(threaded_8XY5, execute_opcode_8XY5(op->instruction))
+        THREADED_OP(threaded_8XY6, execute_opcode_8XY6(op->instruction))
+        THREADED_OP(threaded_8XY7, execute_opcode_8XY7(op->instruction))
+        THREADED_OP(threaded_8XYE, execute_opcode_8XYE(op->instruction))
+        THREADED_OP(threaded_9XY0, execute_opcode_9XY0(op->instruction))
+        THREADED_OP(threaded_ANNN, execute_opcode_ANNN(op->instruction))
+        THREADED_OP(threaded_BNNN, execute_opcode_BNNN(op->instruction))
+        THREADED_OP(threaded_CXNN, execute_opcode_CXNN(op->instruction))
+        THREADED_OP(threaded_DXYN, execute_opcode_DXYN(op->instruction, ram, display))
+        THREADED_OP(threaded_EX9E, execute_opcode_EX9E(op->instruction, keyboard))
+        THREADED_OP(threaded_EXA1, execute_opcode_EXA1(op->instruction, keyboard))
+        THREADED_OP(threaded_FX07, execute_opcode_FX07(op->instruction, delay_timer))
+        THREADED_OP(threaded_FX0A, execute_opcode_FX0A(op->instruction, keyboard); if (_state->waiting_for_key) { cycles = executed; })
+        THREADED_OP(threaded_FX15, execute_opcode_FX15(op->instruction, delay_timer))
+        THREADED_OP(threaded_FX18, execute_opcode_FX18(op->instruction, sound_timer))
+        THREADED_OP(threaded_FX1E, execute_opcode_FX1E(op->instruction))
+        THREADED_OP(threaded_FX29, execute_opcode_FX29(op->instruction, ram))
+        THREADED_OP(threaded_FX33, execute_opcode_FX33(op->instruction, ram))
+        THREADED_OP(threaded_FX55, execute_opcode_FX55(op->instruction, ram))
+        THREADED_OP(threaded_FX65, execute_opcode_FX65(op->instruction, ram))
+
+        THREADED_FUSED(threaded_6XNN_6XNN, execute_opcode_6XNN(op->instruction), execute_opcode_6XNN(next->instruction))
+        THREADED_FUSED(threaded_6XNN_ANNN, execute_opcode_6XNN(op->instruction), execute_opcode_ANNN(next->instruction))
+        THREADED_FUSED(threaded_ANNN_DXYN, execute_opcode_ANNN(op->instruction), execute_opcode_DXYN(next->instruction, ram, display))
+        THREADED_FUSED(threaded_7XNN_3XNN, execute_opcode_7XNN(op->instruction), execute_opcode_3XNN(next->instruction))
+        THREADED_FUSED(threaded_ANNN_FX65, execute_opcode_ANNN(op->instruction), execute_opcode_FX65(next->instruction, ram))
+
+#if CHIP8_THREADED_GOTO
+    threaded_done:
+#else
+                default:
+                    break;
+            }
+        }
+#endif
+
+#undef THREADED_FUSED
+#undef THREADED_OP
+#undef THREADED_SINGLE
+#undef THREADED_DISPATCH
+#undef THREADED_CASE
+
+        return executed;
+    }
+
+    int32_t cProcessor::run_pair_profiling(int32_t cycles, const sPeripherals& peripherals)
+    {
+        int32_t executed = 0;
 
-        _program_counter += 2;
+        for (; executed < cycles && !_state->waiting_for_key; executed++)
+        {
+            const sCachedInstruction& cached = get_cached_instruction(peripherals.ram);
+            eOpcode                   type = static_cast<eOpcode>(cached.handler_index);
+
+            // Only pairs that sit next to each other in memory can be fused.
+            if (_profiled_address >= 0 && _profiled_address + 2 == _state->program_counter)
+            {
+                _pair_counts[static_cast<size_t>(_profiled_type) * OPCODE_COUNT + static_cast<size_t>(type)]++;
+            }
+
+            _profiled_address = _state->program_counter;
+            _profiled_type = type;
+
+            _state->program_counter += 2;
+            _dispatch_table->handlers[cached.handler_index](this, cached.instruction, peripherals);
+        }
+
+        return executed;
+    }
+
+    void cProcessor::set_pair_profiling(bool enabled)
+    {
+        _profile_pairs = enabled;
+        _profiled_address = -1;
+
+        if (_pair_counts.empty())
+        {
+            _pair_counts.assign(OPCODE_COUNT * OPCODE_COUNT, 0U);
+        }
+    }
+
+    int32_t cProcessor::run_traced(int32_t cycles, const sPeripherals& peripherals)
+    {
+        int32_t executed = 0;
+
+        for (; executed < cycles && !_state->waiting_for_key; executed++)
+        {
+            assert(_state->program_counter < peripherals.ram->size() - 1);
+            const sCachedInstruction& cached = get_cached_instruction(peripherals.ram);
+            uint16_t                  program_counter = _state->program_counter;
+            uint16_t                  register_i = _state->register_i;
+
+            uint64_t low = load_register_word(_state->registers);
+            uint64_t high = load_register_word(_state->registers + 8);
+
+            _state->program_counter += 2;
+            _dispatch_table->handlers[cached.handler_index](this, cached.instruction, peripherals);
+
+            uint16_t changed = get_changed_bytes(low, load_register_word(_state->registers)) | get_changed_bytes(high, load_register_word(_state->registers + 8)) << 8;
+            uint8_t register_index = changed != 0U ? static_cast<uint8_t>(__builtin_ctz(changed)) : TRACE_NO_REGISTER;
+            uint8_t register_value = changed != 0U ? _state->registers[register_index] : 0U;
+            _trace->record(program_counter, cached.instruction.opcode, register_i, changed, register_index, register_value);
+        }
+
+        // The scheduler counts the rest of the batch as halted.
+        if (_state->waiting_for_key)
+        {
+            _trace->skip_cycles(cycles - executed);
+        }
+
+        return executed;
+    }
+
+    void cProcessor::set_trace_recorder(cTraceRecorder* recorder)
+    {
+        _trace = recorder;
+    }
+
+    std::vector<cProcessor::sOpcodePairCount> cProcessor::get_pair_profile() const
+    {
+        std::vector<sOpcodePairCount> profile;
+
+        for (size_t i = 0; i < _pair_counts.size(); i++)
+        {
+            if (_pair_counts[i] > 0)
+            {
+                profile.push_back(sOpcodePairCount {static_cast<eOpcode>(i / OPCODE_COUNT), static_cast<eOpcode>(i % OPCODE_COUNT), _pair_counts[i]});
+            }
+        }
+
+        std::sort(profile.begin(), profile.end(), [](const sOpcodePairCount& a, const sOpcodePairCount& b) { return a.count > b.count; });
+        return profile;
+    }
+
+    int32_t cProcessor::run_blocks(int32_t cycles, const sPeripherals& peripherals)
+    {
+        int32_t executed = 0;
+        sBlock* block = nullptr;
+
+        while (executed < cycles)
+        {
+            block = find_next_block(block, peripherals.ram);
+
+            // Blocks are straight-line, so stopping early just leaves the program counter in the middle of one.
+            int32_t         count = std::min(static_cast<int32_t>(block->ops.size()), cycles - executed);
+            const sMicroOp* ops = block->ops.data();
+
+            for (int32_t i = 0; i < count; i++)
+            {
+                _state->program_counter += 2;
+                ops[i].handler(this, ops[i].instruction, peripherals);
+                executed++;
+
+                if (ops[i].writes_ram && !block->valid)
+                {
+                    // The block just overwrote itself. Whatever follows must be translated again.
+                    break;
+                }
+            }
+
+            // FX0A ends a block, so a halt can only happen on the way out of one.
+            if (_state->waiting_for_key)
+            {
+                break;
+            }
+        }
+
+        return executed;
+    }
+
+    int32_t cProcessor::run_jit(int32_t cycles, const sPeripherals& peripherals)
+    {
+        int32_t executed = 0;
+        sBlock* block = nullptr;
+
+        while (executed < cycles)
+        {
+            block = find_next_block(block, peripherals.ram);
+
+            int32_t         count = std::min(static_cast<int32_t>(block->ops.size()), cycles - executed);
+            const sMicroOp* ops = block->ops.data();
+
+            for (int32_t i = 0; i < count;)
+            {
+                const sMicroOp& op = ops[i];
+
+                // Native runs only touch registers, so they can not invalidate the block.
+                if (op.native != nullptr && op.native_length <= count - i)
+                {
+                    op.native(_state->registers, &_state->register_i);
+                    _state->program_counter += 2 * op.native_length;
+                    executed += op.native_length;
+                    i += op.native_length;
+                    continue;
+                }
+
+                _state->program_counter += 2;
+                op.handler(this, op.instruction, peripherals);
+                executed++;
+                i++;
+
+                if (op.writes_ram && !block->valid)
+                {
+                    break;
+                }
+            }
+
+            if (_state->waiting_for_key)
+            {
+                break;
+            }
+        }
+
+        return executed;
+    }
+
+    cProcessor::sBlock* cProcessor::find_next_block(sBlock* previous, cRam* ram)
+    {
+        // Follow the chain from the block that just finished before falling back to the block table.
+        if (previous != nullptr)
+        {
+            for (sBlock* successor : previous->successors)
+            {
+                if (successor != nullptr && successor->start == _state->program_counter && successor->valid)
+                {
+                    return successor;
+                }
+            }
+        }
+
+        assert(_state->program_counter < ram->size() - 1);
+        sBlock* block = &_blocks[_state->program_counter];
+
+        if (!block->valid)
+        {
+            translate_block(block, ram);
+        }
+
+        if (previous != nullptr && previous->valid)
+        {
+            // Keep the most recent exit in slot 0. Conditional blocks end up with both exits chained.
+            previous->successors[1] = previous->successors[0];
+            previous->successors[0] = block;
+        }
+
+        return block;
+    }
+
+    void cProcessor::translate_block(sBlock* block, cRam* ram)
+    {
+        block->ops.clear();
+        block->successors = {nullptr, nullptr};
+        block->start = _state->program_counter;
+        block->valid = true;
+
+        int32_t address = _state->program_counter;
+
+        while (address < ram->size() - 1 && block->ops.size() < MAX_BLOCK_LENGTH)
+        {
+            uint16_t opcode = (static_cast<uint16_t>(ram->read(address)) << 8) | ram->read(address + 1);
+            uint8_t  handler_index = _dispatch_table->handler_index[opcode];
+            eOpcode  type = static_cast<eOpcode>(handler_index);
+
+            bool writes_ram = type == eOpcode::opcode_FX33 || type == eOpcode::opcode_FX55;
+            block->ops.push_back(sMicroOp {_dispatch_table->handlers[handler_index], decode_instruction(opcode), writes_ram, nullptr, 0});
+
+            _block_code[address] = true;
+            _block_code[address + 1] = true;
+            address += 2;
+
+            if (ends_block(type))
+            {
+                break;
+            }
+        }
+
+        if (_dispatch_mode == eDispatchMode::jit && _jit->is_available())
+        {
+            compile_block(block);
+        }
+    }
+
+    void cProcessor::compile_block(sBlock* block)
+    {
+        std::vector<sMicroOp>& ops = block->ops;
+        int32_t                op_count = static_cast<int32_t>(ops.size());
+
+        std::vector<sInstruction> run;
+
+        for (int32_t first = 0; first < op_count;)
+        {
+            int32_t last = first;
+            while (last < op_count && cJitCompiler::can_compile(static_cast<eOpcode>(_dispatch_table->handler_index[ops[last].instruction.opcode])))
+            {
+                last++;
+            }
+
+            // A single instruction is not worth leaving the interpreter for.
+            if (last - first >= 2)
+            {
+                run.clear();
+                for (int32_t i = first; i < last; i++)
+                {
+                    run.push_back(ops[i].instruction);
+                }
+
+                cJitCompiler::tNativeCode native = _jit->compile(run.data(), last - first);
+                if (native == nullptr)
+                {
+                    // Out of code space. Drop every compiled block and start over with this one.
+                    _jit->reset();
+                    for (sBlock& other : _blocks)
+                    {
+                        other.valid = false;
+                    }
+                    block->valid = true;
+                    for (sMicroOp& op : ops)
+                    {
+                        op.native = nullptr;
+                        op.native_length = 0;
+                    }
+
+                    native = _jit->compile(run.data(), last - first);
+                }
+
+                // Only the first op of the run carries the code. Budgets ending mid run interpret the rest.
+                ops[first].native = native;
+                ops[first].native_length = last - first;
+            }
+
+            first = std::max(last, first + 1);
+        }
+    }
+
+    void cProcessor::invalidate_blocks(int32_t index, int32_t length)
+    {
+        int32_t last = std::min(static_cast<int32_t>(_block_code.size()), index + length);
+
+        for (int32_t written = std::max(0, index); written < last; written++)
+        {
+            if (!_block_code[written])
+            {
+                continue;
+            }
+
+            // Any block starting up to MAX_BLOCK_LENGTH instructions earlier may cover this byte.
+            int32_t first_start = std::max(0, written - 2 * MAX_BLOCK_LENGTH + 1);
+            for (int32_t start = first_start; start <= written; start++)
+            {
+                sBlock& block = _blocks[start];
+                if (block.valid && start + 2 * static_cast<int32_t>(block.ops.size()) > written)
+                {
+                    block.valid = false;
+                }
+            }
+        }
+    }
+
+    void cProcessor::execute_decoded_table(const sInstruction& instruction, const sPeripherals& peripherals)
+    {
+        uint8_t handler_index = _dispatch_table->handler_index[instruction.opcode];
+        _dispatch_table->handlers[handler_index](this, instruction, peripherals);
+    }
+
+    void cProcessor::execute_decoded_switch(const sInstruction& instruction, const sPeripherals& peripherals)
+    {
+        cRam*      ram = peripherals.ram;
+        cDisplay*  display = peripherals.display;
+        cKeyboard* keyboard = peripherals.keyboard;
+        cTimer*    delay_timer = peripherals.delay_timer;
+        cTimer*    sound_timer = peripherals.sound_timer;
+
+        // Opcode = Nibble 1234
+        uint8_t nibble1 = (instruction.opcode >> 12) & 0x000F;
 
         switch (nibble1)
         {
             case 0x00:
             {
-                execute_opcode_0XXX(opcode, ram, display);
+                execute_opcode_0XXX(instruction, ram, display);
             }
             break;
             case 0x01:
             {
-                execute_opcode_1NNN(opcode);
+                execute_opcode_1NNN(instruction);
             }
             break;
             case 0x02:
             {
-                execute_opcode_2NNN(opcode, ram);
+                execute_opcode_2NNN(instruction, ram);
             }
             break;
             case 0x03:
             {
-                execute_opcode_3XNN(opcode);
+                execute_opcode_3XNN(instruction);
             }
             break;
             case 0x04:
             {
-                execute_opcode_4XNN(opcode);
+                execute_opcode_4XNN(instruction);
             }
             break;
             case 0x05:
             {
-                execute_opcode_5XY0(opcode);
+                execute_opcode_5XY0(instruction);
             }
             break;
             case 0x06:
             {
-                execute_opcode_6XNN(opcode);
+                execute_opcode_6XNN(instruction);
             }
             break;
             case 0x07:
             {
-                execute_opcode_7XNN(opcode);
+                execute_opcode_7XNN(instruction);
             }
             break;
             case 0x08:
             {
-                execute_opcode_8XXX(opcode);
+                execute_opcode_8XXX(instruction);
             }
             break;
             case 0x09:
             {
-                execute_opcode_9XY0(opcode);
+                execute_opcode_9XY0(instruction);
             }
             break;
             case 0x0A:
             {
-                execute_opcode_ANNN(opcode);
+                execute_opcode_ANNN(instruction);
             }
             break;
             case 0x0B:
             {
-                execute_opcode_BNNN(opcode);
+                execute_opcode_BNNN(instruction);
             }
             break;
             case 0x0C:
             {
-                execute_opcode_CXNN(opcode);
+                execute_opcode_CXNN(instruction);
             }
             break;
             case 0x0D:
             {
-                execute_opcode_DXYN(opcode, ram, display);
+                execute_opcode_DXYN(instruction, ram, display);
             }
             break;
             case 0x0E:
             {
                 // Needs keyboard.
-                execute_opcode_EXXX(opcode, keyboard);
+                execute_opcode_EXXX(instruction, keyboard);
             }
             break;
             case 0x0F:
             {
                 // Needs timers
                 // Needs keyboard.
-                execute_opcode_FXXX(opcode, ram, keyboard, delay_timer, sound_timer);
+                execute_opcode_FXXX(instruction, ram, keyboard, delay_timer, sound_timer);
             }
             break;
             default:
             {
-                thoth::error("Invalid operation %x04", opcode);
+                thoth::error("Invalid operation %x04", instruction.opcode);
                 std::abort();
             }
             break;
         }
     }
 
-    void cProcessor::execute_opcode_0XXX(int16_t opcode, cRam* ram, cDisplay* display)
+    void cProcessor::execute_opcode_0XXX(const sInstruction& instruction, cRam* ram, cDisplay* display)
     {
         // Ignore 0NNNN for now
 
         // Opcode = Nibble 1234
-        uint8_t nibble2 = (opcode >> 8) & 0x000F;
-        uint8_t nibble3 = (opcode >> 4) & 0x000F;
-        uint8_t nibble4 = opcode & 0x000F;
+        uint8_t nibble2 = (instruction.opcode >> 8) & 0x000F;
+        uint8_t nibble3 = (instruction.opcode >> 4) & 0x000F;
+        uint8_t nibble4 = instruction.opcode & 0x000F;
 
         if (nibble2 == 0x0 && nibble3 == 0xE && nibble4 == 0xE)
         {
-            execute_opcode_00EE(opcode, ram);
+            execute_opcode_00EE(instruction, ram);
         }
         else if (nibble2 == 0xE && nibble3 == 0x0 && nibble4 == 0x0)
         {
-            execute_opcode_0E00(opcode, display);
+            execute_opcode_0E00(instruction, display);
         }
         else
         {
-            thoth::error("Invalid operation %x04", opcode);
+            thoth::error("Invalid operation %x04", instruction.opcode);
             std::abort();
         }
     }
 
-    void cProcessor::execute_opcode_8XXX(int16_t opcode)
+    void cProcessor::execute_opcode_8XXX(const sInstruction& instruction)
     {
         // Opcode = Nibble 1234
-        uint8_t nibble4 = opcode & 0x000F;
+        uint8_t nibble4 = instruction.opcode & 0x000F;
 
         switch (nibble4)
         {
             case 0x00:
             {
-                execute_opcode_8XY0(opcode);
+                execute_opcode_8XY0(instruction);
             }
             break;
             case 0x01:
             {
-                execute_opcode_8XY1(opcode);
+                execute_opcode_8XY1(instruction);
             }
             break;
             case 0x02:
             {
-                execute_opcode_8XY2(opcode);
+                execute_opcode_8XY2(instruction);
             }
             break;
             case 0x03:
             {
-                execute_opcode_8XY3(opcode);
+                execute_opcode_8XY3(instruction);
             }
             break;
             case 0x04:
             {
-                execute_opcode_8XY4(opcode);
+                execute_opcode_8XY4(instruction);
             }
             break;
             case 0x05:
             {
-                execute_opcode_8XY5(opcode);
+                execute_opcode_8XY5(instruction);
             }
             break;
             case 0x06:
             {
-                execute_opcode_8XY6(opcode);
+                execute_opcode_8XY6(instruction);
             }
             break;
             case 0x07:
             {
-                execute_opcode_8XY7(opcode);
+                execute_opcode_8XY7(instruction);
             }
             break;
             case 0x0E:
             {
-                execute_opcode_8XYE(opcode);
+                execute_opcode_8XYE(instruction);
             }
             break;
             default:
             {
-                thoth::error("Invalid operation %x04", opcode);
+                thoth::error("Invalid operation %x04", instruction.opcode);
                 std::abort();
             }
 
@@ -213,304 +1280,310 @@ namespace chip8
         }
     }
 
-    void cProcessor::execute_opcode_EXXX(int16_t opcode, cKeyboard* keyboard)
+    void cProcessor::execute_opcode_EXXX(const sInstruction& instruction, cKeyboard* keyboard)
     {
         // Opcode = Nibble 1234
-        uint8_t nibble3 = (opcode >> 4) & 0x000F;
-        uint8_t nibble4 = opcode & 0x000F;
+        uint8_t nibble3 = (instruction.opcode >> 4) & 0x000F;
+        uint8_t nibble4 = instruction.opcode & 0x000F;
 
         if (nibble3 == 0x9 && nibble4 == 0xE)
         {
-            execute_opcode_EX9E(opcode, keyboard);
+            execute_opcode_EX9E(instruction, keyboard);
         }
         else if (nibble3 == 0xA && nibble4 == 0x1)
         {
-            execute_opcode_EXA1(opcode, keyboard);
+            execute_opcode_EXA1(instruction, keyboard);
         }
         else
         {
-            thoth::error("Invalid operation %x04", opcode);
+            thoth::error("Invalid operation %x04", instruction.opcode);
             std::abort();
         }
     }
-    void cProcessor::execute_opcode_FXXX(int16_t opcode, cRam* ram, cKeyboard* keyboard, cTimer* delay_timer, cTimer* sound_timer)
+    void cProcessor::execute_opcode_FXXX(const sInstruction& instruction, cRam* ram, cKeyboard* keyboard, cTimer* delay_timer, cTimer* sound_timer)
     {
         // Opcode = Nibble 1234
-        uint8_t nibble3 = (opcode >> 4) & 0x000F;
-        uint8_t nibble4 = opcode & 0x000F;
+        uint8_t nibble3 = (instruction.opcode >> 4) & 0x000F;
+        uint8_t nibble4 = instruction.opcode & 0x000F;
 
         if (nibble3 == 0x0 && nibble4 == 0x7)
         {
-            execute_opcode_FX07(opcode, delay_timer);
+            execute_opcode_FX07(instruction, delay_timer);
         }
         else if (nibble3 == 0x0 && nibble4 == 0xA)
         {
-            execute_opcode_FX0A(opcode, keyboard);
+            execute_opcode_FX0A(instruction, keyboard);
         }
         else if (nibble3 == 0x1 && nibble4 == 0x5)
         {
-            execute_opcode_FX15(opcode, delay_timer);
+            execute_opcode_FX15(instruction, delay_timer);
         }
         else if (nibble3 == 0x1 && nibble4 == 0x8)
         {
-            execute_opcode_FX18(opcode, sound_timer);
+            execute_opcode_FX18(instruction, sound_timer);
         }
         else if (nibble3 == 0x1 && nibble4 == 0xE)
         {
-            execute_opcode_FX1E(opcode);
+            execute_opcode_FX1E(instruction);
         }
         else if (nibble3 == 0x2 && nibble4 == 0x9)
         {
-            execute_opcode_FX29(opcode, ram);
+            execute_opcode_FX29(instruction, ram);
         }
         else if (nibble3 == 0x3 && nibble4 == 0x3)
         {
-            execute_opcode_FX33(opcode, ram);
+            execute_opcode_FX33(instruction, ram);
         }
         else if (nibble3 == 0x5 && nibble4 == 0x5)
         {
-            execute_opcode_FX55(opcode, ram);
+            execute_opcode_FX55(instruction, ram);
         }
         else if (nibble3 == 0x6 && nibble4 == 0x5)
         {
-            execute_opcode_FX65(opcode, ram);
+            execute_opcode_FX65(instruction, ram);
         }
         else
         {
-            thoth::error("Invalid operation %x04", opcode);
+            thoth::error("Invalid operation %x04", instruction.opcode);
             std::abort();
         }
     }
 
-    void cProcessor::execute_opcode_0E00(int16_t opcode, cDisplay* display)
+    void cProcessor::execute_opcode_invalid(const sInstruction& instruction)
+    {
+        thoth::error("Invalid operation %x04", instruction.opcode);
+        std::abort();
+    }
+
+    void cProcessor::execute_opcode_0E00(const sInstruction&, cDisplay* display)
     {
         // Clears screen.
         display->clear_pixels();
     }
 
-    void cProcessor::execute_opcode_00EE(int16_t opcode, cRam* ram)
+    void cProcessor::execute_opcode_00EE(const sInstruction&, cRam* ram)
     {
-        // Return from function
-        _program_counter = ram->pop_from_stack();
+        // Return from function. On underflow execution goes on after the 00EE.
+        ram->pop_from_stack(&_state->program_counter);
     }
 
-    void cProcessor::execute_opcode_1NNN(int16_t opcode)
+    void cProcessor::execute_opcode_1NNN(const sInstruction& instruction)
     {
         // Jumps to NNN.
-        uint16_t jump_position = opcode & 0x0FFF;
-        _program_counter = jump_position;
+        uint16_t jump_position = instruction.nnn;
+        _state->program_counter = jump_position;
     }
 
-    void cProcessor::execute_opcode_2NNN(int16_t opcode, cRam* ram)
+    void cProcessor::execute_opcode_2NNN(const sInstruction& instruction, cRam* ram)
     {
-        // Calls subroutine at NNN
-        uint16_t jump_position = opcode & 0x0FFF;
-        ram->push_to_stack(_program_counter);
-        _program_counter = jump_position;
+        // Calls subroutine at NNN. On overflow the jump still happens, without a way back.
+        uint16_t jump_position = instruction.nnn;
+        ram->push_to_stack(_state->program_counter);
+        _state->program_counter = jump_position;
     }
 
-    void cProcessor::execute_opcode_3XNN(int16_t opcode)
+    void cProcessor::execute_opcode_3XNN(const sInstruction& instruction)
     {
         // If vx == NN, skip next instruction
-        size_t  register_index = (opcode >> 8) & 0x0F;
-        uint8_t register_content = _registers[register_index];
-        uint8_t constant = opcode & 0xFF;
+        size_t  register_index = instruction.x;
+        uint8_t register_content = _state->registers[register_index];
+        uint8_t constant = instruction.nn;
         if (register_content == constant)
         {
-            _program_counter += 2U;
+            _state->program_counter += 2U;
         }
     }
 
-    void cProcessor::execute_opcode_4XNN(int16_t opcode)
+    void cProcessor::execute_opcode_4XNN(const sInstruction& instruction)
     {
         // If vx != NN, skip the next instruction
-        size_t  register_index = (opcode >> 8) & 0x0F;
-        uint8_t register_content = _registers[register_index];
-        uint8_t constant = opcode & 0xFF;
+        size_t  register_index = instruction.x;
+        uint8_t register_content = _state->registers[register_index];
+        uint8_t constant = instruction.nn;
         if (register_content != constant)
         {
-            _program_counter += 2U;
+            _state->program_counter += 2U;
         }
     }
 
-    void cProcessor::execute_opcode_5XY0(int16_t opcode)
+    void cProcessor::execute_opcode_5XY0(const sInstruction& instruction)
     {
         // Skip next instruction if Vx == Vy
-        size_t  register_index_x = (opcode >> 8) & 0x0F;
-        uint8_t register_content_x = _registers[register_index_x];
-        size_t  register_index_y = (opcode >> 4) & 0x0F;
-        uint8_t register_content_y = _registers[register_index_y];
+        size_t  register_index_x = instruction.x;
+        uint8_t register_content_x = _state->registers[register_index_x];
+        size_t  register_index_y = instruction.y;
+        uint8_t register_content_y = _state->registers[register_index_y];
         if (register_content_x == register_content_y)
         {
-            _program_counter += 2U;
+            _state->program_counter += 2U;
         }
     }
 
-    void cProcessor::execute_opcode_6XNN(int16_t opcode)
+    void cProcessor::execute_opcode_6XNN(const sInstruction& instruction)
     {
         // Set VX to NN
-        size_t  register_index = (opcode >> 8) & 0x0F;
-        uint8_t constant = opcode & 0xFF;
-        _registers[register_index] = constant;
+        size_t  register_index = instruction.x;
+        uint8_t constant = instruction.nn;
+        _state->registers[register_index] = constant;
     }
 
-    void cProcessor::execute_opcode_7XNN(int16_t opcode)
+    void cProcessor::execute_opcode_7XNN(const sInstruction& instruction)
     {
         // Adds NN to Vx (carry flag is not changed)
-        size_t  register_index = (opcode >> 8) & 0x0F;
-        uint8_t constant = opcode & 0xFF;
-        _registers[register_index] += constant;
+        size_t  register_index = instruction.x;
+        uint8_t constant = instruction.nn;
+        _state->registers[register_index] += constant;
     }
 
-    void cProcessor::execute_opcode_8XY0(int16_t opcode)
+    void cProcessor::execute_opcode_8XY0(const sInstruction& instruction)
     {
         // Vx = Vy
-        size_t  register_index_x = (opcode >> 8) & 0x0F;
-        size_t  register_index_y = (opcode >> 4) & 0x0F;
-        uint8_t register_content_y = _registers[register_index_y];
-        _registers[register_index_x] = register_content_y;
+        size_t  register_index_x = instruction.x;
+        size_t  register_index_y = instruction.y;
+        uint8_t register_content_y = _state->registers[register_index_y];
+        _state->registers[register_index_x] = register_content_y;
     }
 
-    void cProcessor::execute_opcode_8XY1(int16_t opcode)
+    void cProcessor::execute_opcode_8XY1(const sInstruction& instruction)
     {
         // Vx |= Vy
-        size_t  register_index_x = (opcode >> 8) & 0x0F;
-        size_t  register_index_y = (opcode >> 4) & 0x0F;
-        uint8_t register_content_y = _registers[register_index_y];
-        _registers[register_index_x] |= register_content_y;
+        size_t  register_index_x = instruction.x;
+        size_t  register_index_y = instruction.y;
+        uint8_t register_content_y = _state->registers[register_index_y];
+        _state->registers[register_index_x] |= register_content_y;
     }
 
-    void cProcessor::execute_opcode_8XY2(int16_t opcode)
+    void cProcessor::execute_opcode_8XY2(const sInstruction& instruction)
     {
         // Vx &= Vy
-        size_t  register_index_x = (opcode >> 8) & 0x0F;
-        size_t  register_index_y = (opcode >> 4) & 0x0F;
-        uint8_t register_content_y = _registers[register_index_y];
-        _registers[register_index_x] &= register_content_y;
+        size_t  register_index_x = instruction.x;
+        size_t  register_index_y = instruction.y;
+        uint8_t register_content_y = _state->registers[register_index_y];
+        _state->registers[register_index_x] &= register_content_y;
     }
 
-    void cProcessor::execute_opcode_8XY3(int16_t opcode)
+    void cProcessor::execute_opcode_8XY3(const sInstruction& instruction)
     {
         // Vx ^= Vy
-        size_t  register_index_x = (opcode >> 8) & 0x0F;
-        size_t  register_index_y = (opcode >> 4) & 0x0F;
-        uint8_t register_content_y = _registers[register_index_y];
-        _registers[register_index_x] ^= register_content_y;
+        size_t  register_index_x = instruction.x;
+        size_t  register_index_y = instruction.y;
+        uint8_t register_content_y = _state->registers[register_index_y];
+        _state->registers[register_index_x] ^= register_content_y;
     }
 
-    void cProcessor::execute_opcode_8XY4(int16_t opcode)
+    void cProcessor::execute_opcode_8XY4(const sInstruction& instruction)
     {
         // Vx += Vy. Set VF to 1 if there is overflow, to 0 if not.
-        size_t  register_index_x = (opcode >> 8) & 0x0F;
-        uint8_t register_content_x = _registers[register_index_x];
-        size_t  register_index_y = (opcode >> 4) & 0x0F;
-        uint8_t register_content_y = _registers[register_index_y];
+        size_t  register_index_x = instruction.x;
+        uint8_t register_content_x = _state->registers[register_index_x];
+        size_t  register_index_y = instruction.y;
+        uint8_t register_content_y = _state->registers[register_index_y];
         uint8_t sum = register_content_x + register_content_y;
-        _registers[register_index_x] = sum;
+        _state->registers[register_index_x] = sum;
         if (sum < register_content_x)
         {
-            _registers[15] = 1;
+            _state->registers[15] = 1;
         }
         else
         {
-            _registers[15] = 0;
+            _state->registers[15] = 0;
         }
     }
 
-    void cProcessor::execute_opcode_8XY5(int16_t opcode)
+    void cProcessor::execute_opcode_8XY5(const sInstruction& instruction)
     {
         // Vx -= Vy. Vf set to 0 if there is underflow, to 0 if not (VF set to 1 if Vx >= Vy)
-        size_t  register_index_x = (opcode >> 8) & 0x0F;
-        uint8_t register_content_x = _registers[register_index_x];
-        size_t  register_index_y = (opcode >> 4) & 0x0F;
-        uint8_t register_content_y = _registers[register_index_y];
+        size_t  register_index_x = instruction.x;
+        uint8_t register_content_x = _state->registers[register_index_x];
+        size_t  register_index_y = instruction.y;
+        uint8_t register_content_y = _state->registers[register_index_y];
         uint8_t diff = register_content_x - register_content_y;
-        _registers[register_index_x] = diff;
+        _state->registers[register_index_x] = diff;
 
         if (register_content_x >= register_content_y)
         {
-            _registers[15] = 1;
+            _state->registers[15] = 1;
         }
         else
         {
-            _registers[15] = 0;
+            _state->registers[15] = 0;
         }
     }
 
-    void cProcessor::execute_opcode_8XY6(int16_t opcode)
+    void cProcessor::execute_opcode_8XY6(const sInstruction& instruction)
     {
         // Vx >>= 1. Store least significand bit of Vx prior to shift to VF.
-        size_t  register_index = (opcode >> 8) & 0x0F;
-        uint8_t register_content = _registers[register_index];
-        _registers[15] = register_content & 0x01;
-        _registers[register_index] = register_content >> 1;
+        size_t  register_index = instruction.x;
+        uint8_t register_content = _state->registers[register_index];
+        _state->registers[15] = register_content & 0x01;
+        _state->registers[register_index] = register_content >> 1;
     }
 
-    void cProcessor::execute_opcode_8XY7(int16_t opcode)
+    void cProcessor::execute_opcode_8XY7(const sInstruction& instruction)
     {
         // Vx = Vy - Vx. Vf set to 0 if Vy >= Vx, to 1 otherwise.
-        size_t  register_index_x = (opcode >> 8) & 0x0F;
-        uint8_t register_content_x = _registers[register_index_x];
-        size_t  register_index_y = (opcode >> 4) & 0x0F;
-        uint8_t register_content_y = _registers[register_index_y];
+        size_t  register_index_x = instruction.x;
+        uint8_t register_content_x = _state->registers[register_index_x];
+        size_t  register_index_y = instruction.y;
+        uint8_t register_content_y = _state->registers[register_index_y];
         uint8_t diff = register_content_y - register_content_x;
-        _registers[register_index_x] = diff;
+        _state->registers[register_index_x] = diff;
 
         if (register_content_y >= register_content_x)
         {
-            _registers[15] = 1;
+            _state->registers[15] = 1;
         }
         else
         {
-            _registers[15] = 0;
+            _state->registers[15] = 0;
         }
     }
 
-    void cProcessor::execute_opcode_8XYE(int16_t opcode)
+    void cProcessor::execute_opcode_8XYE(const sInstruction& instruction)
     {
         // Vx <<= 1. Set Vf to 1 if most significanf bit of Vx prior to shift was set, to 0 otherwise.
-        size_t  register_index = (opcode >> 8) & 0x0F;
-        uint8_t register_content = _registers[register_index];
-        _registers[15] = (register_content & 0x80) >> 7;
-        _registers[register_index] = register_content << 1;
+        size_t  register_index = instruction.x;
+        uint8_t register_content = _state->registers[register_index];
+        _state->registers[15] = (register_content & 0x80) >> 7;
+        _state->registers[register_index] = register_content << 1;
     }
 
-    void cProcessor::execute_opcode_9XY0(int16_t opcode)
+    void cProcessor::execute_opcode_9XY0(const sInstruction& instruction)
     {
         // Skip next instruction if Vx != Vy
-        size_t  register_index_x = (opcode >> 8) & 0x0F;
-        uint8_t register_content_x = _registers[register_index_x];
-        size_t  register_index_y = (opcode >> 4) & 0x0F;
-        uint8_t register_content_y = _registers[register_index_y];
+        size_t  register_index_x = instruction.x;
+        uint8_t register_content_x = _state->registers[register_index_x];
+        size_t  register_index_y = instruction.y;
+        uint8_t register_content_y = _state->registers[register_index_y];
         if (register_content_x != register_content_y)
         {
-            _program_counter += 2U;
+            _state->program_counter += 2U;
         }
     }
 
-    void cProcessor::execute_opcode_ANNN(int16_t opcode)
+    void cProcessor::execute_opcode_ANNN(const sInstruction& instruction)
     {
         // I = NNN
-        uint16_t constant = opcode & 0x0FFF;
-        _register_i = constant;
+        uint16_t constant = instruction.nnn;
+        _state->register_i = constant;
     }
 
-    void cProcessor::execute_opcode_BNNN(int16_t opcode)
+    void cProcessor::execute_opcode_BNNN(const sInstruction& instruction)
     {
         // PC = V0 + NNN
-        uint16_t constant = opcode & 0x0FFF;
-        _program_counter = static_cast<uint16_t>(_registers[0]) + constant;
+        uint16_t constant = instruction.nnn;
+        _state->program_counter = static_cast<uint16_t>(_state->registers[0]) + constant;
     }
 
-    void cProcessor::execute_opcode_CXNN(int16_t opcode)
+    void cProcessor::execute_opcode_CXNN(const sInstruction& instruction)
     {
         // Vx = rand(0,255) & NN
-        uint8_t constant = opcode & 0x00FF;
-        size_t  register_index = (opcode >> 8) & 0x0F;
-        _registers[register_index] = static_cast<uint8_t>((rand() % 255)) & constant;
+        uint8_t constant = instruction.nn;
+        size_t  register_index = instruction.x;
+        _state->registers[register_index] = cRandom::next_byte(&_state->random_state) & constant;
     }
 
-    void cProcessor::execute_opcode_DXYN(int16_t opcode, cRam* ram, cDisplay* display)
+    void cProcessor::execute_opcode_DXYN(const sInstruction& instruction, cRam* ram, cDisplay* display)
     {
         // draw(vx, vy, N). Draw a sprite at coordinate Vx, Vy
         // that has a width of 8 pixels and a height of N pixels.
@@ -518,153 +1591,146 @@ namespace chip8
         // I does no change.
         // Set VF to 1 if any bits are flipped from set to unset when drawing, 0 if that does not happen.
 
-        size_t  register_index_x = (opcode >> 8) & 0x0F;
-        uint8_t register_content_x = _registers[register_index_x];
-        size_t  register_index_y = (opcode >> 4) & 0x0F;
-        uint8_t register_content_y = _registers[register_index_y];
-
-        uint8_t sprite_start_x = register_content_x % display->get_width();
-        uint8_t sprite_start_y = register_content_y % display->get_height();
-
-        uint8_t sprite_height = opcode & 0xF;
+        size_t  register_index_x = instruction.x;
+        uint8_t register_content_x = _state->registers[register_index_x];
+        size_t  register_index_y = instruction.y;
+        uint8_t register_content_y = _state->registers[register_index_y];
 
-        bool flipped_any_bit {false};
+        // Rows 0 to N, both included.
+        int32_t row_count = instruction.n + 1;
 
-        for (uint8_t i {0}; i <= sprite_height; i++)
+        uint8_t sprite_rows[MAX_SPRITE_HEIGHT];
+        for (int32_t i {0}; i < row_count; i++)
         {
-            uint8_t sprite_row = ram->read(_register_i + i);
-            bool    row_flipped_any_bit {false};
-            display->draw_byte(sprite_start_x, sprite_start_y + i, sprite_row, &row_flipped_any_bit);
-            flipped_any_bit |= row_flipped_any_bit;
+            sprite_rows[i] = ram->read(_state->register_i + i);
         }
 
-        _registers[15] = flipped_any_bit ? 1 : 0;
+        bool flipped_any_bit = display->draw_sprite(register_content_x, register_content_y, sprite_rows, row_count);
+
+        _state->registers[15] = flipped_any_bit ? 1 : 0;
     }
 
-    void cProcessor::execute_opcode_EX9E(int16_t opcode, cKeyboard* keyboard)
+    void cProcessor::execute_opcode_EX9E(const sInstruction& instruction, cKeyboard* keyboard)
     {
         // Skip next instruction if key stored in Vx (consider only lowest nibble (half-bit)) is pressed.
-        size_t register_index = (opcode >> 8) & 0x0F;
-        bool   key_pressed = keyboard->is_key_pressed(_registers[register_index]);
+        size_t register_index = instruction.x;
+        bool   key_pressed = keyboard->is_key_pressed(_state->registers[register_index]);
         if (key_pressed)
         {
-            _program_counter += 2;
+            _state->program_counter += 2;
         }
     }
 
-    void cProcessor::execute_opcode_EXA1(int16_t opcode, cKeyboard* keyboard)
+    void cProcessor::execute_opcode_EXA1(const sInstruction& instruction, cKeyboard* keyboard)
     {
         // Skip next instruction if key stored in Vx (consider only lowest nibble (half-bit)) is NOT pressed.
-        size_t register_index = (opcode >> 8) & 0x0F;
-        bool   key_pressed = keyboard->is_key_pressed(_registers[register_index]);
+        size_t register_index = instruction.x;
+        bool   key_pressed = keyboard->is_key_pressed(_state->registers[register_index]);
         if (!key_pressed)
         {
-            _program_counter += 2;
+            _state->program_counter += 2;
         }
     }
 
-    void cProcessor::execute_opcode_FX07(int16_t opcode, cTimer* delay_timer)
+    void cProcessor::execute_opcode_FX07(const sInstruction& instruction, cTimer* delay_timer)
     {
         // Sets vx to the current value of the delay timer
-        size_t register_index = (opcode >> 8) & 0x0F;
-        _registers[register_index] = delay_timer->get_time();
+        size_t register_index = instruction.x;
+        _state->registers[register_index] = delay_timer->get_time();
     }
 
-    void cProcessor::execute_opcode_FX0A(int16_t opcode, cKeyboard* keyboard)
+    void cProcessor::execute_opcode_FX0A(const sInstruction& instruction, cKeyboard* keyboard)
     {
-        // A key press is awaited, then stored in Vx
-        // If no key is pressed we decrement program counter as to execute this instruction again.
-        // But sound and delay timers keep processing.
+        // A key press is awaited, then stored in Vx.
+        // Without one the processor halts until the keyboard delivers a press. Sound and delay timers keep running.
         int8_t pressed_key = keyboard->await_key_press();
 
         if (pressed_key == -1)
         {
-            _program_counter -= 2;
-            return;
-        }
-        else
-        {
-            size_t register_index = (opcode >> 8) & 0x0F;
-            _registers[register_index] = static_cast<uint8_t>(pressed_key);
+            _state->waiting_for_key = 1U;
+            _state->key_register = instruction.x;
             return;
         }
+
+        size_t register_index = instruction.x;
+        _state->registers[register_index] = static_cast<uint8_t>(pressed_key);
     }
 
-    void cProcessor::execute_opcode_FX15(int16_t opcode, cTimer* delay_timer)
+    void cProcessor::execute_opcode_FX15(const sInstruction& instruction, cTimer* delay_timer)
     {
         // Sets delay timer to Vx
-        size_t register_index = (opcode >> 8) & 0x0F;
-        delay_timer->set_time(_registers[register_index]);
+        size_t register_index = instruction.x;
+        delay_timer->set_time(_state->registers[register_index]);
     }
 
-    void cProcessor::execute_opcode_FX18(int16_t opcode, cTimer* sound_timer)
+    void cProcessor::execute_opcode_FX18(const sInstruction& instruction, cTimer* sound_timer)
     {
         // Sets sound timer to Vx
-        size_t register_index = (opcode >> 8) & 0x0F;
-        sound_timer->set_time(_registers[register_index]);
+        size_t register_index = instruction.x;
+        sound_timer->set_time(_state->registers[register_index]);
     }
 
-    void cProcessor::execute_opcode_FX1E(int16_t opcode)
+    void cProcessor::execute_opcode_FX1E(const sInstruction& instruction)
     {
         // I += Vx. Vf is not affected.
-        size_t register_index = (opcode >> 8) & 0x0F;
-        _register_i += _registers[register_index];
+        size_t register_index = instruction.x;
+        _state->register_i += _state->registers[register_index];
 
-        if (_register_i > RAM_SIZE)
+        if (_state->register_i > RAM_SIZE)
         {
-            _register_i -= (RAM_SIZE + 1);
+            _state->register_i -= (RAM_SIZE + 1);
         }
 
-        if (_register_i < 0U)
+        if (_state->register_i < 0U)
         {
-            _register_i += (RAM_SIZE + 1);
+            _state->register_i += (RAM_SIZE + 1);
         }
     }
 
-    void cProcessor::execute_opcode_FX29(int16_t opcode, cRam* ram)
+    void cProcessor::execute_opcode_FX29(const sInstruction& instruction, cRam* ram)
     {
         // Okay so somewhere in memory are sprites for the characters 0-9 and A-F, in 4x5 font.
         // This instruction read the lowest nibble (half bit) of Vx and then sets I to the location
         // In memory where you can find the sprite for said character.
-        uint8_t  character = opcode & 0xF;
+        uint8_t  character = instruction.n;
         uint16_t position = ram->get_font_char_position(character);
-        _register_i = position;
+        _state->register_i = position;
     }
 
-    void cProcessor::execute_opcode_FX33(int16_t opcode, cRam* ram)
+    void cProcessor::execute_opcode_FX33(const sInstruction& instruction, cRam* ram)
     {
         // Takes the number in Vx. Reads it as in decimal. Like if Vx is OxE7 it considers it 231.
         // Then stores 231 in I, like it stores 2 in I, 3 in I+1 and 1 in I+2.
         // This is called binary coded decimal.
-        size_t  register_index = (opcode >> 8) & 0x0F;
-        uint8_t register_content = _registers[register_index];
+        size_t  register_index = instruction.x;
+        uint8_t register_content = _state->registers[register_index];
         uint8_t units = register_content % 10;
         uint8_t tens = (register_content % 100) / 10;
         uint8_t hundreds = register_content / 100;
-        ram->write(_register_i, hundreds);
-        ram->write(_register_i + 1, tens);
-        ram->write(_register_i + 2, units);
+        ram->write(_state->register_i, hundreds);
+        ram->write(_state->register_i + 1, tens);
+        ram->write(_state->register_i + 2, units);
     }
 
-    void cProcessor::execute_opcode_FX55(int16_t opcode, cRam* ram)
+    void cProcessor::execute_opcode_FX55(const sInstruction& instruction, cRam* ram)
     {
         // Stores from V0 to Vx (including Vx) in memory, starting at adress I.
         // I is not modified.
-        size_t register_index = (opcode >> 8) & 0x0F;
+        size_t register_index = instruction.x;
         for (size_t i {0U}; i <= register_index; i++)
         {
-            ram->write(_register_i + i, _registers[i]);
+            ram->write(_state->register_i + i, _state->registers[i]);
         }
     }
 
-    void cProcessor::execute_opcode_FX65(int16_t opcode, cRam* ram)
+    void cProcessor::execute_opcode_FX65(const sInstruction& instruction, cRam* ram)
     {
         // Fills V0 to Vx (including Vx) with values from memory, starting at adress I.
         // I is not modified.
-        size_t register_index = (opcode >> 8) & 0x0F;
+        size_t register_index = instruction.x;
         for (size_t i {0U}; i <= register_index; i++)
         {
-            _registers[i] = ram->read(_register_i + i);
+            _state->registers[i] = ram->read(_state->register_i + i);
         }
     }
 }
@@ -1,68 +1,254 @@
 #ifndef CHIP8_SRC_PROCESSORHPP
 #define CHIP8_SRC_PROCESSORHPP
 
+#include "jit.hpp"
+#include "opcode.hpp"
+#include "random.hpp"
+
+#include <array>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace chip8
 {
     constexpr int32_t REGISTER_COUNT = 16;
+    constexpr int32_t MAX_BLOCK_LENGTH = 64; // Longest straight-line run translated into a single block.
 
     class cDisplay;
     class cKeyboard;
     class cRam;
     class cTimer;
+    class cTraceRecorder;
+    struct sMachineState;
 
     class cProcessor
     {
       public:
-        cProcessor(int32_t program_start_location, int32_t register_count);
+        enum class eDispatchMode
+        {
+            switch_decoder, // Reference decoder. Nested switch/if chains on the opcode nibbles.
+            table,          // One indexed lookup on the full opcode.
+            decode_cache,   // Table dispatch on instructions decoded once per program counter.
+            block,          // Runs whole translated basic blocks per dispatch.
+            jit,            // Block engine with register only runs compiled to native x86-64. Falls back to block on other hosts.
+            threaded,       // Threaded code with computed goto and fused instruction pairs.
+        };
+
+        // How often an instruction was directly followed by the next one in memory.
+        struct sOpcodePairCount
+        {
+            eOpcode  first;
+            eOpcode  second;
+            uint64_t count;
+        };
+
+        // View over the registers, I, program counter, key wait and generator of the given state.
+        // Decode caches are not part of the state, they follow ram through its write listeners.
+        cProcessor(sMachineState* state, int32_t program_start_location);
+        ~cProcessor(); // Removes the write listener from the attached ram, which has to outlive the processor.
+
+        // The attached ram's listener points at this processor.
+        cProcessor(const cProcessor&) = delete;
+        cProcessor& operator=(const cProcessor&) = delete;
 
         void execute_next_instruction(cRam* ram, cDisplay* display, cKeyboard* keyboard, cTimer* delay_timer, cTimer* sound_timer);
 
+        // Executes the given number of instructions without per instruction logging. Returns the number executed,
+        // which is less when FX0A halts the processor. While halted it only checks the keyboard for a press.
+        int32_t run_cycles(int32_t cycles, cRam* ram, cDisplay* display, cKeyboard* keyboard, cTimer* delay_timer, cTimer* sound_timer);
+
+        // Covers up to cycles instructions of a loop that only polls the delay timer (FX07, 3XNN or 4XNN on the same register,
+        // 1NNN back to the FX07) without executing it. Leaves the machine exactly as running the instructions would have.
+        // Returns the instructions covered, 0 when not in such a loop.
+        int32_t skip_idle_loop(int32_t cycles, cRam* ram, cDisplay* display, cKeyboard* keyboard, cTimer* delay_timer, cTimer* sound_timer);
+
+        // Set by FX0A when no key was pressed. Timers keep running, instructions do not.
+        bool is_waiting_for_key() const;
+
+        // Stores a pending key press in the register FX0A named and lets execution continue. False while there is none.
+        bool resume_key_wait(cKeyboard* keyboard);
+
+        void          set_dispatch_mode(eDispatchMode mode);
+        eDispatchMode get_dispatch_mode() const;
+
+        // While enabled, run_cycles counts consecutive instruction pairs instead of dispatching with the selected mode.
+        void                          set_pair_profiling(bool enabled);
+        std::vector<sOpcodePairCount> get_pair_profile() const; // Most frequent first.
+
+        // While set, run_cycles records every instruction it executes and the cycles it spends halted, using the decode cache
+        // whatever the dispatch mode. Idle loops are not skipped, so the trace holds every instruction. Null stops recording.
+        void set_trace_recorder(cTraceRecorder* recorder);
+
+        uint8_t  get_register(int32_t index) const;
+        void     set_register(int32_t index, uint8_t value);
+        uint16_t get_register_i() const;
+        void     set_register_i(uint16_t value);
+        uint16_t get_program_counter() const;
+        void     set_program_counter(uint16_t value);
+
+        // CXNN draws from a generator of this processor only. Setting the seed restarts its sequence.
+        void     set_random_seed(uint64_t seed);
+        uint64_t get_random_seed() const;
+        uint64_t get_random_state() const; // Position in the sequence, what a save state has to keep.
+        void     set_random_state(uint64_t state);
+
       private:
-        void execute_opcode_0XXX(int16_t opcode, cRam* ram, cDisplay* display);
-        void execute_opcode_0E00(int16_t opcode, cDisplay* display);
-        void execute_opcode_00EE(int16_t opcode, cRam* ram);
-        void execute_opcode_1NNN(int16_t opcode);
-        void execute_opcode_2NNN(int16_t opcode, cRam* ram);
-        void execute_opcode_3XNN(int16_t opcode);
-        void execute_opcode_4XNN(int16_t opcode);
-        void execute_opcode_5XY0(int16_t opcode);
-        void execute_opcode_6XNN(int16_t opcode);
-        void execute_opcode_7XNN(int16_t opcode);
-        void execute_opcode_8XXX(int16_t opcode);
-        void execute_opcode_8XY0(int16_t opcode);
-        void execute_opcode_8XY1(int16_t opcode);
-        void execute_opcode_8XY2(int16_t opcode);
-        void execute_opcode_8XY3(int16_t opcode);
-        void execute_opcode_8XY4(int16_t opcode);
-        void execute_opcode_8XY5(int16_t opcode);
-        void execute_opcode_8XY6(int16_t opcode);
-        void execute_opcode_8XY7(int16_t opcode);
-        void execute_opcode_8XYE(int16_t opcode);
-        void execute_opcode_9XY0(int16_t opcode);
-        void execute_opcode_ANNN(int16_t opcode);
-        void execute_opcode_BNNN(int16_t opcode);
-        void execute_opcode_CXNN(int16_t opcode);
-        void execute_opcode_DXYN(int16_t opcode, cRam* ram, cDisplay* display);
-        void execute_opcode_EXXX(int16_t opcode, cKeyboard* keyboard);
-        void execute_opcode_EX9E(int16_t opcode, cKeyboard* keyboard);
-        void execute_opcode_EXA1(int16_t opcode, cKeyboard* keyboard);
-        void execute_opcode_FXXX(int16_t opcode, cRam* ram, cKeyboard* keyboard, cTimer* delay_timer, cTimer* sound_timer); // Needs sound and delay timers.
-        void execute_opcode_FX07(int16_t opcode, cTimer* delay_timer);
-        void execute_opcode_FX0A(int16_t opcode, cKeyboard* keyboard);
-        void execute_opcode_FX15(int16_t opcode, cTimer* delay_timer);
-        void execute_opcode_FX18(int16_t opcode, cTimer* sound_timer);
-        void execute_opcode_FX1E(int16_t opcode);
-        void execute_opcode_FX29(int16_t opcode, cRam* ram);
-        void execute_opcode_FX33(int16_t opcode, cRam* ram);
-        void execute_opcode_FX55(int16_t opcode, cRam* ram);
-        void execute_opcode_FX65(int16_t opcode, cRam* ram);
-
-        uint16_t             _program_counter;
-        uint16_t             _register_i;
-        std::vector<uint8_t> _registers;
+        struct sPeripherals
+        {
+            cRam*      ram;
+            cDisplay*  display;
+            cKeyboard* keyboard;
+            cTimer*    delay_timer;
+            cTimer*    sound_timer;
+        };
+
+        using tOpcodeHandler = void (*)(cProcessor* processor, const sInstruction& instruction, const sPeripherals& peripherals);
+
+        // Two level table: the full opcode selects a byte sized handler index, which selects the handler.
+        // A byte wide index keeps the table at 64 KB instead of 512 KB of function pointers.
+        struct sDispatchTable
+        {
+            std::array<uint8_t, 0x10000>              handler_index;
+            std::array<tOpcodeHandler, OPCODE_COUNT> handlers;
+        };
+
+        // Decoded instruction for a single program counter. Filled the first time that address is executed.
+        struct sCachedInstruction
+        {
+            sInstruction instruction;
+            uint8_t      handler_index;
+            bool         valid;
+        };
+
+        struct sMicroOp
+        {
+            tOpcodeHandler handler;
+            sInstruction   instruction;
+            bool           writes_ram; // The block may have been invalidated by this op.
+
+            // Native code for this op and the ones following it, when the jit compiled them.
+            cJitCompiler::tNativeCode native;
+            int32_t                   native_length;
+        };
+
+        // Straight-line run of instructions starting at a program counter. Only the last op can change control flow.
+        struct sBlock
+        {
+            std::vector<sMicroOp> ops;
+            std::array<sBlock*, 2> successors {nullptr, nullptr}; // Blocks control flow was last seen going to.
+            uint16_t               start {0U};
+            bool                   valid {false};
+        };
+
+        // Slot of the threaded interpreter. Kind is either an eOpcode or a fused pair taking its second
+        // instruction from the following slot.
+        struct sThreadedOp
+        {
+            uint8_t      kind;
+            uint8_t      single_kind; // Kind to run when only one cycle is left.
+            bool         valid;
+            sInstruction instruction;
+        };
+
+        static const sDispatchTable& get_dispatch_table();
+
+        void init(sMachineState* state, int32_t program_start_location);
+
+        uint16_t                  fetch_opcode(cRam* ram);
+        const sCachedInstruction& get_cached_instruction(cRam* ram);
+        void                      attach_ram(cRam* ram);
+        void                      reset_caches();
+        void                      on_ram_write(int32_t index, int32_t length);
+        void                      invalidate_instruction_cache(int32_t index, int32_t length);
+
+        int32_t            run_threaded(int32_t cycles, const sPeripherals& peripherals);
+        const sThreadedOp& get_threaded_op(cRam* ram);
+        void               decode_threaded_op(uint16_t address, cRam* ram);
+        void               invalidate_threaded_ops(int32_t index, int32_t length);
+
+        int32_t run_pair_profiling(int32_t cycles, const sPeripherals& peripherals);
+        int32_t run_traced(int32_t cycles, const sPeripherals& peripherals);
+
+        bool is_delay_wait_loop(int32_t address, cRam* ram) const;
+
+        int32_t run_blocks(int32_t cycles, const sPeripherals& peripherals);
+        int32_t run_jit(int32_t cycles, const sPeripherals& peripherals);
+        sBlock* find_next_block(sBlock* previous, cRam* ram);
+        void    translate_block(sBlock* block, cRam* ram);
+        void    compile_block(sBlock* block);
+        void    invalidate_blocks(int32_t index, int32_t length);
+
+        void execute_decoded_switch(const sInstruction& instruction, const sPeripherals& peripherals);
+        void execute_decoded_table(const sInstruction& instruction, const sPeripherals& peripherals);
+
+        void execute_opcode_invalid(const sInstruction& instruction);
+        void execute_opcode_0XXX(const sInstruction& instruction, cRam* ram, cDisplay* display);
+        void execute_opcode_0E00(const sInstruction& instruction, cDisplay* display);
+        void execute_opcode_00EE(const sInstruction& instruction, cRam* ram);
+        void execute_opcode_1NNN(const sInstruction& instruction);
+        void execute_opcode_2NNN(const sInstruction& instruction, cRam* ram);
+        void execute_opcode_3XNN(const sInstruction& instruction);
+        void execute_opcode_4XNN(const sInstruction& instruction);
+        void execute_opcode_5XY0(const sInstruction& instruction);
+        void execute_opcode_6XNN(const sInstruction& instruction);
+        void execute_opcode_7XNN(const sInstruction& instruction);
+        void execute_opcode_8XXX(const sInstruction& instruction);
+        void execute_opcode_8XY0(const sInstruction& instruction);
+        void execute_opcode_8XY1(const sInstruction& instruction);
+        void execute_opcode_8XY2(const sInstruction& instruction);
+        void execute_opcode_8XY3(const sInstruction& instruction);
+        void execute_opcode_8XY4(const sInstruction& instruction);
+        void execute_opcode_8XY5(const sInstruction& instruction);
+        void execute_opcode_8XY6(const sInstruction& instruction);
+        void execute_opcode_8XY7(const sInstruction& instruction);
+        void execute_opcode_8XYE(const sInstruction& instruction);
+        void execute_opcode_9XY0(const sInstruction& instruction);
+        void execute_opcode_ANNN(const sInstruction& instruction);
+        void execute_opcode_BNNN(const sInstruction& instruction);
+        void execute_opcode_CXNN(const sInstruction& instruction);
+        void execute_opcode_DXYN(const sInstruction& instruction, cRam* ram, cDisplay* display);
+        void execute_opcode_EXXX(const sInstruction& instruction, cKeyboard* keyboard);
+        void execute_opcode_EX9E(const sInstruction& instruction, cKeyboard* keyboard);
+        void execute_opcode_EXA1(const sInstruction& instruction, cKeyboard* keyboard);
+        void execute_opcode_FXXX(const sInstruction& instruction, cRam* ram, cKeyboard* keyboard, cTimer* delay_timer, cTimer* sound_timer); // Needs sound and delay timers.
+        void execute_opcode_FX07(const sInstruction& instruction, cTimer* delay_timer);
+        void execute_opcode_FX0A(const sInstruction& instruction, cKeyboard* keyboard);
+        void execute_opcode_FX15(const sInstruction& instruction, cTimer* delay_timer);
+        void execute_opcode_FX18(const sInstruction& instruction, cTimer* sound_timer);
+        void execute_opcode_FX1E(const sInstruction& instruction);
+        void execute_opcode_FX29(const sInstruction& instruction, cRam* ram);
+        void execute_opcode_FX33(const sInstruction& instruction, cRam* ram);
+        void execute_opcode_FX55(const sInstruction& instruction, cRam* ram);
+        void execute_opcode_FX65(const sInstruction& instruction, cRam* ram);
+
+        // Registers, I, program counter, key wait and the CXNN generator. The generator is per instance,
+        // so processors can run side by side and repeat exactly.
+        sMachineState* _state;
+        int32_t        _register_count;
+
+        eDispatchMode         _dispatch_mode {eDispatchMode::switch_decoder};
+        const sDispatchTable* _dispatch_table {nullptr};
+
+        // Ram the caches below were built from, and the write listener registered with it.
+        cRam*   _attached_ram {nullptr};
+        int32_t _ram_listener {-1};
+
+        std::vector<sCachedInstruction> _instruction_cache;
+
+        std::vector<sBlock> _blocks;     // Indexed by block start address.
+        std::vector<bool>   _block_code; // Bytes that are (or were) part of a translated block.
+
+        std::unique_ptr<cJitCompiler> _jit;
+
+        std::vector<sThreadedOp> _threaded_ops;
+
+        bool                  _profile_pairs {false};
+        std::vector<uint64_t> _pair_counts;         // OPCODE_COUNT x OPCODE_COUNT.
+        int32_t               _profiled_address {-1}; // Address of the last profiled instruction.
+        eOpcode               _profiled_type {eOpcode::invalid};
+
+        cTraceRecorder* _trace {nullptr};
     };
 }
 
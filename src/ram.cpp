@@ -1,26 +1,29 @@
 #include "ram.hpp"
 #include "log.hpp"
+#include "machine_state.hpp"
 
 #include <assert.h>
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 
 namespace chip8
 {
-    cRam::cRam(int32_t size, int32_t program_offset)
+    cRam::cRam(sMachineState* state, int32_t program_offset, int32_t stack_depth)
+      : _state(state)
+      , _size(RAM_SIZE)
+      , _program_offset(program_offset)
+      , _stack_depth(stack_depth)
     {
-        _stack.clear();
-        _program_offset = program_offset;
-        _ram = std::vector<uint8_t>(size, 0);
+        assert(stack_depth > 0 && stack_depth <= MAX_STACK_DEPTH);
     }
 
     void cRam::clear()
     {
-        for (int32_t i = 0; i < _ram.size(); i++)
-        {
-            _ram[i] = 0;
-        }
+        std::fill(_state->ram, _state->ram + _size, 0U);
+
+        notify_write(0, _size);
     }
 
     int32_t cRam::load_rom(std::string path)
@@ -35,9 +38,9 @@ namespace chip8
 
         std::cout << "[ INFO] ROM was loaded correctly" << std::endl;
 
-        uint64_t max_program_size {_ram.size() - _program_offset};
+        uint64_t max_program_size = static_cast<uint64_t>(_size - _program_offset);
 
-        file.read(reinterpret_cast<char*>(&_ram[_program_offset]), max_program_size);
+        file.read(reinterpret_cast<char*>(&_state->ram[_program_offset]), max_program_size);
 
         std::streamsize bytes_read = file.gcount();
         if (bytes_read >= max_program_size)
@@ -46,167 +49,269 @@ namespace chip8
         }
 
         init_font();
+        notify_write(0, _size);
 
         std::cout << "[DEBUG] Ram has been sucessfully filled" << std::endl;
         return 0;
     }
 
+    int32_t cRam::load_rom(const uint8_t* data, int32_t size)
+    {
+        int32_t max_program_size = _size - _program_offset;
+        if (size > max_program_size)
+        {
+            return -1;
+        }
+
+        std::copy(data, data + size, _state->ram + _program_offset);
+
+        init_font();
+        notify_write(0, _size);
+        return 0;
+    }
+
     void cRam::init_font()
     {
-        size_t index {FONT_START_LOCATION};
+        uint8_t* ram = _state->ram;
+        size_t   index {FONT_START_LOCATION};
 
         // 0.
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b1001 << 4;
-        _ram[index++] = 0b1001 << 4;
-        _ram[index++] = 0b1001 << 4;
-        _ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1001 << 4;
+        ram[index++] = 0b1001 << 4;
+        ram[index++] = 0b1001 << 4;
+        ram[index++] = 0b1111 << 4;
 
         // 1.
-        _ram[index++] = 0b0010 << 4;
-        _ram[index++] = 0b0110 << 4;
-        _ram[index++] = 0b0010 << 4;
-        _ram[index++] = 0b0010 << 4;
-        _ram[index++] = 0b0111 << 4;
+        ram[index++] = 0b0010 << 4;
+        ram[index++] = 0b0110 << 4;
+        ram[index++] = 0b0010 << 4;
+        ram[index++] = 0b0010 << 4;
+        ram[index++] = 0b0111 << 4;
 
         // 2.
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b0001 << 4;
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b1000 << 4;
-        _ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b0001 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1000 << 4;
+        ram[index++] = 0b1111 << 4;
 
         // 3.
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b0001 << 4;
-        _ram[index++] = 0b0111 << 4;
-        _ram[index++] = 0b0001 << 4;
-        _ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b0001 << 4;
+        ram[index++] = 0b0111 << 4;
+        ram[index++] = 0b0001 << 4;
+        ram[index++] = 0b1111 << 4;
 
         // 4.
-        _ram[index++] = 0b1001 << 4;
-        _ram[index++] = 0b1001 << 4;
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b0001 << 4;
-        _ram[index++] = 0b0001 << 4;
+        ram[index++] = 0b1001 << 4;
+        ram[index++] = 0b1001 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b0001 << 4;
+        ram[index++] = 0b0001 << 4;
 
         // 5.
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b1000 << 4;
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b0001 << 4;
-        _ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1000 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b0001 << 4;
+        ram[index++] = 0b1111 << 4;
 
         // 6.
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b1000 << 4;
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b1001 << 4;
-        _ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1000 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1001 << 4;
+        ram[index++] = 0b1111 << 4;
 
         // 7.
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b0001 << 4;
-        _ram[index++] = 0b0001 << 4;
-        _ram[index++] = 0b0001 << 4;
-        _ram[index++] = 0b0001 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b0001 << 4;
+        ram[index++] = 0b0001 << 4;
+        ram[index++] = 0b0001 << 4;
+        ram[index++] = 0b0001 << 4;
 
         // 8.
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b1001 << 4;
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b1001 << 4;
-        _ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1001 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1001 << 4;
+        ram[index++] = 0b1111 << 4;
 
         // 9.
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b1001 << 4;
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b0001 << 4;
-        _ram[index++] = 0b0001 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1001 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b0001 << 4;
+        ram[index++] = 0b0001 << 4;
 
         // A.
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b1001 << 4;
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b1001 << 4;
-        _ram[index++] = 0b1001 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1001 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1001 << 4;
+        ram[index++] = 0b1001 << 4;
 
         // B.
-        _ram[index++] = 0b1110 << 4;
-        _ram[index++] = 0b1001 << 4;
-        _ram[index++] = 0b1110 << 4;
-        _ram[index++] = 0b1001 << 4;
-        _ram[index++] = 0b1110 << 4;
+        ram[index++] = 0b1110 << 4;
+        ram[index++] = 0b1001 << 4;
+        ram[index++] = 0b1110 << 4;
+        ram[index++] = 0b1001 << 4;
+        ram[index++] = 0b1110 << 4;
 
         // C.
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b1000 << 4;
-        _ram[index++] = 0b1000 << 4;
-        _ram[index++] = 0b1000 << 4;
-        _ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1000 << 4;
+        ram[index++] = 0b1000 << 4;
+        ram[index++] = 0b1000 << 4;
+        ram[index++] = 0b1111 << 4;
 
         // D.
-        _ram[index++] = 0b1110 << 4;
-        _ram[index++] = 0b1001 << 4;
-        _ram[index++] = 0b1001 << 4;
-        _ram[index++] = 0b1001 << 4;
-        _ram[index++] = 0b1110 << 4;
+        ram[index++] = 0b1110 << 4;
+        ram[index++] = 0b1001 << 4;
+        ram[index++] = 0b1001 << 4;
+        ram[index++] = 0b1001 << 4;
+        ram[index++] = 0b1110 << 4;
 
         // E.
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b1000 << 4;
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b1000 << 4;
-        _ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1000 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1000 << 4;
+        ram[index++] = 0b1111 << 4;
 
         // F.
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b1000 << 4;
-        _ram[index++] = 0b1111 << 4;
-        _ram[index++] = 0b1000 << 4;
-        _ram[index++] = 0b1000 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1000 << 4;
+        ram[index++] = 0b1111 << 4;
+        ram[index++] = 0b1000 << 4;
+        ram[index++] = 0b1000 << 4;
     }
 
     int32_t cRam::size()
     {
-        return _ram.size();
+        return _size;
     }
 
     uint8_t cRam::read(int32_t index)
     {
-        assert(index < _ram.size());
-        // std::printf("[TRACE] Reading ram in position %d result %02x\n", index, _ram[index]);
-        return _ram[index];
+        assert(index < _size);
+        // std::printf("[TRACE] Reading ram in position %d result %02x\n", index, _state->ram[index]);
+        return _state->ram[index];
     }
 
     void cRam::write(int32_t index, uint8_t value)
     {
-        assert(index < _ram.size());
-        _ram[index] = value;
+        assert(index < _size);
+        _state->ram[index] = value;
+        notify_write(index, 1);
+    }
+
+    bool cRam::push_to_stack(uint16_t value)
+    {
+        if (_state->stack_pointer == _stack_depth)
+        {
+            // Runaway recursion overflows on every call, so only the first one is logged.
+            if (_stack_overflows++ == 0)
+            {
+                thoth::error("Stack overflow, calls nest deeper than %d levels", _stack_depth);
+            }
+
+            return false;
+        }
+
+        _state->stack[_state->stack_pointer++] = value;
+        return true;
+    }
+
+    bool cRam::pop_from_stack(uint16_t* value)
+    {
+        if (_state->stack_pointer == 0)
+        {
+            if (_stack_underflows++ == 0)
+            {
+                thoth::error("Stack underflow, return without a call");
+            }
+
+            return false;
+        }
+
+        *value = _state->stack[--_state->stack_pointer];
+        return true;
+    }
+
+    int32_t cRam::get_stack_depth() const
+    {
+        return _stack_depth;
+    }
+
+    int32_t cRam::get_stack_size() const
+    {
+        return _state->stack_pointer;
+    }
+
+    uint16_t cRam::get_stack_entry(int32_t index) const
+    {
+        assert(index < _state->stack_pointer);
+        return _state->stack[index];
+    }
+
+    bool cRam::set_stack(const uint16_t* entries, int32_t size)
+    {
+        if (size < 0 || size > _stack_depth)
+        {
+            return false;
+        }
+
+        std::copy(entries, entries + size, _state->stack);
+        _state->stack_pointer = size;
+        return true;
     }
 
-    void cRam::push_to_stack(uint16_t value)
+    int64_t cRam::get_stack_overflows() const
     {
-        _stack.push_back(value);
+        return _stack_overflows;
     }
 
-    uint16_t cRam::pop_from_stack()
+    int64_t cRam::get_stack_underflows() const
     {
-        assert(_stack.size() > 0);
-        uint16_t value = _stack.back();
-        _stack.pop_back();
-        return value;
+        return _stack_underflows;
     }
 
     uint16_t cRam::get_font_char_position(uint8_t character)
     {
         assert(character <= 0xF);
-        uint32_t position = FONT_START_LOCATION + character * FONT_SIZE;
-        assert(position < _ram.size());
+        int32_t position = FONT_START_LOCATION + character * FONT_SIZE;
+        assert(position < _size);
         return static_cast<uint16_t>(position);
     }
 
+    int32_t cRam::add_write_listener(tWriteListener listener)
+    {
+        _write_listeners.push_back({_next_listener_id, std::move(listener)});
+        return _next_listener_id++;
+    }
+
+    void cRam::remove_write_listener(int32_t id)
+    {
+        auto found = std::find_if(_write_listeners.begin(), _write_listeners.end(), [id](const sWriteListener& listener) { return listener.id == id; });
+        assert(found != _write_listeners.end());
+        _write_listeners.erase(found);
+    }
+
+    void cRam::mark_written(int32_t index, int32_t length)
+    {
+        notify_write(index, length);
+    }
+
+    void cRam::notify_write(int32_t index, int32_t length)
+    {
+        for (const sWriteListener& listener : _write_listeners)
+        {
+            listener.function(index, length);
+        }
+    }
+
     void cRam::print()
     {
         int32_t lines_width = 16; //  bytes per line.
@@ -215,11 +320,11 @@ namespace chip8
 
         thoth::debug("Printing ram\n");
 
-        for (int y = 0; y < _ram.size() / lines_width; y++)
+        for (int y = 0; y < _size / lines_width; y++)
         {
             for (int x = 0; x < lines_width; x++)
             {
-                uint8_t current_byte = _ram[y * lines_width + x];
+                uint8_t current_byte = _state->ram[y * lines_width + x];
                 printf("%02x ", current_byte);
                 if ((x + 1) % bytes_per_segment == 0)
                 {
@@ -2,6 +2,7 @@
 #define CHIP8_SRC_RAMHPP
 
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -12,12 +13,23 @@ namespace chip8
     constexpr int32_t FONT_START_LOCATION = 0x50;
     constexpr int32_t FONT_SIZE = 5;
 
+    // Call depth. The original interpreter had 12 levels, most later ones 16, some up to 64.
+    constexpr int32_t DEFAULT_STACK_DEPTH = 16;
+    constexpr int32_t MAX_STACK_DEPTH = 64;
+
+    struct sMachineState;
+
     class cRam
     {
       public:
-        cRam(int32_t size, int32_t program_offset);
+        // Called whenever a range of ram is modified. Lets decoders drop anything they cached for it.
+        using tWriteListener = std::function<void(int32_t index, int32_t length)>;
+
+        // View over the ram and stack of the given state, RAM_SIZE bytes.
+        cRam(sMachineState* state, int32_t program_offset, int32_t stack_depth = DEFAULT_STACK_DEPTH);
 
         int32_t load_rom(std::string path);
+        int32_t load_rom(const uint8_t* data, int32_t size);
         void    clear();
         void    print();
 
@@ -25,17 +37,49 @@ namespace chip8
         uint8_t read(int32_t index);
         void    write(int32_t index, uint8_t value);
 
-        void     push_to_stack(uint16_t value);
-        uint16_t pop_from_stack();
+        // Pushing onto a full stack or popping from an empty one fails, is counted (the first time logged) and leaves
+        // the stack as it was. Neither ever allocates.
+        bool push_to_stack(uint16_t value);
+        bool pop_from_stack(uint16_t* value);
+
+        int32_t  get_stack_depth() const;
+        int32_t  get_stack_size() const;
+        uint16_t get_stack_entry(int32_t index) const; // Bottom of the stack first.
+        bool     set_stack(const uint16_t* entries, int32_t size); // False if size is over the depth.
+
+        int64_t get_stack_overflows() const;
+        int64_t get_stack_underflows() const;
 
         uint16_t get_font_char_position(uint8_t character);
 
+        // Returns an id for remove_write_listener. Whoever adds a listener removes it before it goes away, the ram
+        // itself has to outlive every listener still registered.
+        int32_t add_write_listener(tWriteListener listener);
+        void    remove_write_listener(int32_t id);
+
+        // For changes made to the state behind the ram's back, like restoring a snapshot.
+        void mark_written(int32_t index, int32_t length);
+
       private:
         void init_font();
+        void notify_write(int32_t index, int32_t length);
+
+        sMachineState* _state; // Ram bytes, stack entries and stack pointer.
+        int32_t        _size;
+        int32_t        _program_offset;
+
+        int32_t _stack_depth;
+        int64_t _stack_overflows {0};
+        int64_t _stack_underflows {0};
+
+        struct sWriteListener
+        {
+            int32_t        id;
+            tWriteListener function;
+        };
 
-        int32_t               _program_offset;
-        std::vector<uint8_t>  _ram;
-        std::vector<uint16_t> _stack;
+        std::vector<sWriteListener> _write_listeners;
+        int32_t                     _next_listener_id {0};
     };
 }
 
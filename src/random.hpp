@@ -0,0 +1,81 @@
+#ifndef CHIP8_SRC_RANDOMHPP
+#define CHIP8_SRC_RANDOMHPP
+
+#include <cstdint>
+
+namespace chip8
+{
+    constexpr uint64_t DEFAULT_RANDOM_SEED = 0x853C49E6748FEA9BULL;
+
+    // PCG32 (XSH RR). Same sequence on every platform for a given seed, and its whole state is one word.
+    class cRandom
+    {
+      public:
+        explicit cRandom(uint64_t seed = DEFAULT_RANDOM_SEED)
+          : _state(get_seeded_state(seed))
+        {
+        }
+
+        // Restarts the sequence.
+        void set_seed(uint64_t seed)
+        {
+            _state = get_seeded_state(seed);
+        }
+
+        uint32_t next()
+        {
+            return next(&_state);
+        }
+
+        // Uniform over 0-255.
+        uint8_t next_byte()
+        {
+            return next_byte(&_state);
+        }
+
+        // Position in the sequence, for save states. Not the seed.
+        uint64_t get_state() const
+        {
+            return _state;
+        }
+
+        void set_state(uint64_t state)
+        {
+            _state = state;
+        }
+
+        // The same generator over a state word kept elsewhere, like in sMachineState.
+        static constexpr uint64_t get_seeded_state(uint64_t seed)
+        {
+            uint64_t state = 0U;
+            next(&state);
+            state += seed;
+            next(&state);
+            return state;
+        }
+
+        static constexpr uint32_t next(uint64_t* state)
+        {
+            uint64_t old_state = *state;
+            *state = old_state * MULTIPLIER + INCREMENT;
+
+            uint32_t xorshifted = static_cast<uint32_t>(((old_state >> 18U) ^ old_state) >> 27U);
+            uint32_t rotation = static_cast<uint32_t>(old_state >> 59U);
+            return (xorshifted >> rotation) | (xorshifted << ((32U - rotation) & 31U));
+        }
+
+        // The high bits are the best ones.
+        static constexpr uint8_t next_byte(uint64_t* state)
+        {
+            return static_cast<uint8_t>(next(state) >> 24U);
+        }
+
+      private:
+        static constexpr uint64_t MULTIPLIER = 6364136223846793005ULL;
+        static constexpr uint64_t INCREMENT = 1442695040888963407ULL;
+
+        uint64_t _state {0U};
+    };
+}
+
+#endif // CHIP8_SRC_RANDOMHPP
@@ -0,0 +1,47 @@
+#include "ram.hpp"
+#include "recompiler.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        std::cout << "Usage: 8chip_recompile <rom.ch8> <output.cpp>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream rom_file {argv[1], std::ios::binary | std::ios::in};
+    if (!rom_file.is_open())
+    {
+        std::cout << "[ERROR] Could not open rom " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<uint8_t> rom {std::istreambuf_iterator<char>(rom_file), std::istreambuf_iterator<char>()};
+    if (rom.size() > chip8::RAM_SIZE - chip8::PROGRAM_START_LOCATION)
+    {
+        std::cout << "[ERROR] Rom " << argv[1] << " does not fit in ram" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    chip8::cRecompiler recompiler {rom};
+    std::string        source = recompiler.generate(argv[1]);
+
+    std::ofstream output_file {argv[2], std::ios::out | std::ios::trunc};
+    if (!output_file.is_open())
+    {
+        std::cout << "[ERROR] Could not write " << argv[2] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    output_file << source;
+
+    std::cout << "[INFO] Recompiled " << recompiler.get_instruction_count() << " instructions in " << recompiler.get_block_count() << " blocks into " << argv[2]
+              << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,186 @@
+#include "recompiled_runtime.hpp"
+
+#include "display.hpp"
+#include "keyboard.hpp"
+#include "ram.hpp"
+
+#include <assert.h>
+
+namespace chip8
+{
+    void recompiled_draw_sprite(sRecompiledContext& context, uint8_t register_index_x, uint8_t register_index_y, uint8_t sprite_height)
+    {
+        int32_t row_count = sprite_height + 1;
+
+        uint8_t sprite_rows[MAX_SPRITE_HEIGHT];
+        for (int32_t i {0}; i < row_count; i++)
+        {
+            sprite_rows[i] = context.ram->read(context.register_i + i);
+        }
+
+        bool flipped_any_bit = context.display->draw_sprite(context.registers[register_index_x], context.registers[register_index_y], sprite_rows, row_count);
+
+        context.registers[15] = flipped_any_bit ? 1 : 0;
+    }
+
+    cRecompiledRunner::cRecompiledRunner(cProcessor* processor, cRam* ram)
+      : _processor(processor)
+      , _ram(ram)
+    {
+        _blocks.assign(ram->size(), nullptr);
+        _compiled_code.assign(ram->size(), false);
+
+        for (int32_t b = 0; b < RECOMPILED_BLOCK_COUNT; b++)
+        {
+            const sRecompiledBlock& block = RECOMPILED_BLOCKS[b];
+            assert(block.end <= ram->size());
+
+            // Only trust code that still matches the ROM the blocks were generated from.
+            bool matches_rom = true;
+            for (int32_t address = block.start; address < block.end; address++)
+            {
+                int32_t rom_offset = address - PROGRAM_START_LOCATION;
+                uint8_t expected = rom_offset >= 0 && rom_offset < RECOMPILED_ROM_SIZE ? RECOMPILED_ROM[rom_offset] : 0U;
+                matches_rom &= ram->read(address) == expected;
+                _compiled_code[address] = true;
+            }
+
+            if (matches_rom)
+            {
+                _blocks[block.start] = &block;
+            }
+        }
+
+        // Self-modifying code falls back to the interpreter from then on.
+        _ram_listener = ram->add_write_listener([this](int32_t index, int32_t length) { disable_blocks(index, length); });
+    }
+
+    cRecompiledRunner::~cRecompiledRunner()
+    {
+        _ram->remove_write_listener(_ram_listener);
+    }
+
+    int32_t cRecompiledRunner::run_cycles(int32_t cycles, cRam* ram, cDisplay* display, cKeyboard* keyboard, cTimer* delay_timer, cTimer* sound_timer)
+    {
+        assert(ram == _ram);
+
+        _context.ram = ram;
+        _context.display = display;
+        _context.keyboard = keyboard;
+        _context.delay_timer = delay_timer;
+        _context.sound_timer = sound_timer;
+
+        keyboard->poll_events();
+
+        // A processor halted on FX0A only runs again once a key was pressed.
+        if (_processor->is_waiting_for_key() && !_processor->resume_key_wait(keyboard))
+        {
+            return 0;
+        }
+
+        load_registers();
+        uint16_t program_counter = _processor->get_program_counter();
+        int32_t  executed = 0;
+
+        while (executed < cycles && !_processor->is_waiting_for_key())
+        {
+            const sRecompiledBlock* block = find_block(program_counter, cycles - executed);
+            if (block != nullptr)
+            {
+                program_counter = block->function(_context);
+                executed += block->length;
+                _native_cycles += block->length;
+                continue;
+            }
+
+            // Interpret until we reach code that was compiled, syncing registers only on the way in and out.
+            store_registers(program_counter);
+            do
+            {
+                _processor->run_cycles(1, ram, display, keyboard, delay_timer, sound_timer);
+                program_counter = _processor->get_program_counter();
+                executed++;
+                _interpreted_cycles++;
+            } while (executed < cycles && !_processor->is_waiting_for_key() && find_block(program_counter, cycles - executed) == nullptr);
+            load_registers();
+        }
+
+        store_registers(program_counter);
+        return executed;
+    }
+
+    int64_t cRecompiledRunner::get_native_cycles() const
+    {
+        return _native_cycles;
+    }
+
+    int64_t cRecompiledRunner::get_interpreted_cycles() const
+    {
+        return _interpreted_cycles;
+    }
+
+    const sRecompiledBlock* cRecompiledRunner::find_block(uint16_t program_counter, int32_t cycles_left) const
+    {
+        if (program_counter >= _blocks.size())
+        {
+            return nullptr;
+        }
+
+        const sRecompiledBlock* block = _blocks[program_counter];
+        if (block == nullptr || block->length > cycles_left)
+        {
+            return nullptr;
+        }
+
+        return block;
+    }
+
+    void cRecompiledRunner::disable_blocks(int32_t index, int32_t length)
+    {
+        bool touches_code = false;
+        for (int32_t address = index; address < index + length && address < _compiled_code.size(); address++)
+        {
+            touches_code |= _compiled_code[address];
+        }
+
+        if (!touches_code)
+        {
+            return;
+        }
+
+        for (int32_t b = 0; b < RECOMPILED_BLOCK_COUNT; b++)
+        {
+            const sRecompiledBlock& block = RECOMPILED_BLOCKS[b];
+            if (block.start < index + length && index < block.end)
+            {
+                // Blocks never overlap, so the bytes stop being compiled code altogether.
+                _blocks[block.start] = nullptr;
+                for (int32_t address = block.start; address < block.end; address++)
+                {
+                    _compiled_code[address] = false;
+                }
+            }
+        }
+    }
+
+    void cRecompiledRunner::load_registers()
+    {
+        for (int32_t i = 0; i < REGISTER_COUNT; i++)
+        {
+            _context.registers[i] = _processor->get_register(i);
+        }
+
+        _context.register_i = _processor->get_register_i();
+    }
+
+    void cRecompiledRunner::store_registers(uint16_t program_counter)
+    {
+        for (int32_t i = 0; i < REGISTER_COUNT; i++)
+        {
+            _processor->set_register(i, _context.registers[i]);
+        }
+
+        _processor->set_register_i(_context.register_i);
+        _processor->set_program_counter(program_counter);
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef CHIP8_SRC_RECOMPILEDRUNTIMEHPP
+#define CHIP8_SRC_RECOMPILEDRUNTIMEHPP
+
+#include "processor.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace chip8
+{
+    class cDisplay;
+    class cKeyboard;
+    class cRam;
+    class cTimer;
+
+    // State shared by the generated block functions. Registers live here while native code runs
+    // and are copied into the cProcessor whenever the interpreter has to take over.
+    struct sRecompiledContext
+    {
+        uint8_t    registers[REGISTER_COUNT];
+        uint16_t   register_i;
+        cRam*      ram;
+        cDisplay*  display;
+        cKeyboard* keyboard;
+        cTimer*    delay_timer;
+        cTimer*    sound_timer;
+    };
+
+    // Executes the whole block and returns the program counter it leaves at.
+    using tRecompiledFunction = uint16_t (*)(sRecompiledContext& context);
+
+    struct sRecompiledBlock
+    {
+        uint16_t            start;  // Address of the first instruction.
+        uint16_t            end;    // One past the last byte of code the block was compiled from.
+        int32_t             length; // Instructions executed by one call.
+        tRecompiledFunction function;
+    };
+
+    // Same drawing rules as cProcessor's DXYN.
+    void recompiled_draw_sprite(sRecompiledContext& context, uint8_t register_index_x, uint8_t register_index_y, uint8_t sprite_height);
+
+    // Defined by the translation unit 8chip_recompile generates.
+    extern const uint8_t          RECOMPILED_ROM[];
+    extern const int32_t          RECOMPILED_ROM_SIZE;
+    extern const sRecompiledBlock RECOMPILED_BLOCKS[];
+    extern const int32_t          RECOMPILED_BLOCK_COUNT;
+
+    // Runs the recompiled blocks, handing indirect jumps, waits and modified code to the interpreter.
+    class cRecompiledRunner
+    {
+      public:
+        // Watches ram for writes to compiled code until destroyed. The ram has to outlive the runner.
+        cRecompiledRunner(cProcessor* processor, cRam* ram);
+        ~cRecompiledRunner();
+
+        cRecompiledRunner(const cRecompiledRunner&) = delete;
+        cRecompiledRunner& operator=(const cRecompiledRunner&) = delete;
+
+        // ram is the one given to the constructor.
+
+        int32_t run_cycles(int32_t cycles, cRam* ram, cDisplay* display, cKeyboard* keyboard, cTimer* delay_timer, cTimer* sound_timer);
+
+        int64_t get_native_cycles() const;
+        int64_t get_interpreted_cycles() const;
+
+      private:
+        const sRecompiledBlock* find_block(uint16_t program_counter, int32_t cycles_left) const;
+        void                    disable_blocks(int32_t index, int32_t length);
+        void                    load_registers();
+        void                    store_registers(uint16_t program_counter);
+
+        cProcessor*                          _processor;
+        cRam*                                _ram;
+        int32_t                              _ram_listener;
+        sRecompiledContext                   _context {};
+        std::vector<const sRecompiledBlock*> _blocks;        // Indexed by program counter.
+        std::vector<bool>                    _compiled_code; // Bytes any block was compiled from.
+        int64_t                              _native_cycles {0};
+        int64_t                              _interpreted_cycles {0};
+    };
+}
+
+#endif // CHIP8_SRC_RECOMPILEDRUNTIMEHPP
@@ -0,0 +1,409 @@
+#include "recompiler.hpp"
+
+#include "ram.hpp"
+
+#include <cstdarg>
+#include <cstdio>
+
+namespace chip8
+{
+    namespace
+    {
+        std::string format(const char* message, ...)
+        {
+            char         buffer[256];
+            std::va_list argp;
+            va_start(argp, message);
+            std::vsnprintf(buffer, sizeof(buffer), message, argp);
+            va_end(argp);
+            return buffer;
+        }
+
+        // Left to the interpreter: indirect jumps, waits and anything depending on its internal state.
+        bool needs_interpreter(eOpcode type)
+        {
+            return type == eOpcode::invalid || type == eOpcode::opcode_BNNN || type == eOpcode::opcode_CXNN || type == eOpcode::opcode_FX0A;
+        }
+
+        // Can modify code, so the runner must check its blocks are still valid afterwards.
+        bool writes_ram(eOpcode type)
+        {
+            return type == eOpcode::opcode_FX33 || type == eOpcode::opcode_FX55;
+        }
+
+        // Emits its own return statement.
+        bool ends_block(eOpcode type)
+        {
+            switch (type)
+            {
+                case eOpcode::opcode_00EE:
+                case eOpcode::opcode_1NNN:
+                case eOpcode::opcode_2NNN:
+                case eOpcode::opcode_3XNN:
+                case eOpcode::opcode_4XNN:
+                case eOpcode::opcode_5XY0:
+                case eOpcode::opcode_9XY0:
+                case eOpcode::opcode_EX9E:
+                case eOpcode::opcode_EXA1:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+    }
+
+    cRecompiler::cRecompiler(std::vector<uint8_t> rom)
+      : _rom(std::move(rom))
+    {
+        _leaders.assign(RAM_SIZE, false);
+        find_leaders();
+    }
+
+    int32_t cRecompiler::get_block_count() const
+    {
+        return _block_count;
+    }
+
+    int32_t cRecompiler::get_instruction_count() const
+    {
+        return _instruction_count;
+    }
+
+    bool cRecompiler::is_code_address(int32_t address) const
+    {
+        return address >= PROGRAM_START_LOCATION && address + 1 < PROGRAM_START_LOCATION + static_cast<int32_t>(_rom.size());
+    }
+
+    uint16_t cRecompiler::read_opcode(int32_t address) const
+    {
+        int32_t offset = address - PROGRAM_START_LOCATION;
+        return (static_cast<uint16_t>(_rom[offset]) << 8) | _rom[offset + 1];
+    }
+
+    void cRecompiler::add_leader(int32_t address, std::vector<int32_t>* worklist)
+    {
+        if (address < 0 || address >= RAM_SIZE || _leaders[address])
+        {
+            return;
+        }
+
+        _leaders[address] = true;
+        worklist->push_back(address);
+    }
+
+    void cRecompiler::find_leaders()
+    {
+        std::vector<int32_t> worklist;
+        std::vector<bool>    visited(RAM_SIZE, false);
+
+        add_leader(PROGRAM_START_LOCATION, &worklist);
+
+        while (!worklist.empty())
+        {
+            int32_t address = worklist.back();
+            worklist.pop_back();
+
+            // Follow straight-line code until control flow leaves it.
+            while (is_code_address(address) && !visited[address])
+            {
+                visited[address] = true;
+
+                sInstruction instruction = decode_instruction(read_opcode(address));
+                eOpcode      type = classify_opcode(instruction.opcode);
+
+                if (type == eOpcode::invalid || type == eOpcode::opcode_00EE || type == eOpcode::opcode_BNNN)
+                {
+                    // Data, a return (its targets are the call sites) or an indirect jump the interpreter resolves.
+                    break;
+                }
+
+                if (type == eOpcode::opcode_1NNN)
+                {
+                    add_leader(instruction.nnn, &worklist);
+                    break;
+                }
+
+                if (type == eOpcode::opcode_2NNN)
+                {
+                    add_leader(instruction.nnn, &worklist);
+                    add_leader(address + 2, &worklist);
+                    break;
+                }
+
+                if (ends_block(type))
+                {
+                    // Conditional skips.
+                    add_leader(address + 2, &worklist);
+                    add_leader(address + 4, &worklist);
+                    break;
+                }
+
+                if (needs_interpreter(type) || writes_ram(type))
+                {
+                    add_leader(address + 2, &worklist);
+                    break;
+                }
+
+                address += 2;
+            }
+        }
+    }
+
+    std::string cRecompiler::generate(const std::string& rom_name)
+    {
+        std::string functions;
+        std::string table;
+
+        _block_count = 0;
+        _instruction_count = 0;
+
+        for (int32_t start = 0; start < RAM_SIZE; start++)
+        {
+            if (!_leaders[start])
+            {
+                continue;
+            }
+
+            int32_t     end = start;
+            int32_t     length = 0;
+            std::string body = generate_block(start, &end, &length);
+            if (length == 0)
+            {
+                continue;
+            }
+
+            functions += format("        uint16_t block_%04x(sRecompiledContext& context)\n", start);
+            functions += "        {\n";
+            functions += "            uint8_t*  v = context.registers;\n";
+            functions += "            uint16_t& i = context.register_i;\n\n";
+            functions += body;
+            functions += "        }\n\n";
+
+            table += format("        {0x%04x, 0x%04x, %d, &block_%04x},\n", start, end, length, start);
+
+            _block_count++;
+            _instruction_count += length;
+        }
+
+        if (_block_count == 0)
+        {
+            // Arrays can not be empty. The count still says zero.
+            table += "        {0x0000, 0x0000, 0, nullptr},\n";
+        }
+
+        std::string rom_bytes;
+        for (size_t i = 0; i < _rom.size(); i++)
+        {
+            rom_bytes += format("%s0x%02x,", i % 16 == 0 ? "\n        " : " ", _rom[i]);
+        }
+
+        if (_rom.empty())
+        {
+            rom_bytes += "\n        0x00,";
+        }
+
+        std::string output;
+        output += format("// Generated by 8chip_recompile from %s. Do not edit.\n", rom_name.c_str());
+        output += "// Blocks: " + std::to_string(_block_count) + ", instructions: " + std::to_string(_instruction_count) + ".\n\n";
+        output += "#include \"display.hpp\"\n";
+        output += "#include \"keyboard.hpp\"\n";
+        output += "#include \"ram.hpp\"\n";
+        output += "#include \"recompiled_runtime.hpp\"\n";
+        output += "#include \"timer.hpp\"\n\n";
+        output += "namespace chip8\n{\n";
+        output += "    namespace\n    {\n";
+        output += functions;
+        output += "    }\n\n";
+        output += "    const uint8_t RECOMPILED_ROM[] = {" + rom_bytes + "\n    };\n\n";
+        output += format("    const int32_t RECOMPILED_ROM_SIZE = %d;\n\n", static_cast<int32_t>(_rom.size()));
+        output += "    const sRecompiledBlock RECOMPILED_BLOCKS[] = {\n" + table + "    };\n\n";
+        output += format("    const int32_t RECOMPILED_BLOCK_COUNT = %d;\n", _block_count);
+        output += "}\n";
+
+        return output;
+    }
+
+    std::string cRecompiler::generate_block(int32_t start, int32_t* end, int32_t* length)
+    {
+        std::string body;
+        int32_t     address = start;
+
+        *length = 0;
+
+        while (true)
+        {
+            if (!is_code_address(address) || (address != start && _leaders[address]))
+            {
+                // Falls through into the next block, or off the end of the ROM where the interpreter takes over.
+                body += format("            return 0x%04x;\n", address);
+                break;
+            }
+
+            sInstruction instruction = decode_instruction(read_opcode(address));
+            eOpcode      type = classify_opcode(instruction.opcode);
+
+            if (needs_interpreter(type))
+            {
+                body += format("            return 0x%04x;\n", address);
+                break;
+            }
+
+            body += format("            // 0x%04x: %04x\n", address, instruction.opcode);
+            body += generate_instruction(type, instruction, address);
+            (*length)++;
+            address += 2;
+
+            if (ends_block(type))
+            {
+                break;
+            }
+
+            if (writes_ram(type))
+            {
+                body += format("            return 0x%04x;\n", address);
+                break;
+            }
+        }
+
+        *end = address;
+        return body;
+    }
+
+    std::string cRecompiler::generate_instruction(eOpcode type, const sInstruction& instruction, int32_t address) const
+    {
+        uint8_t  x = instruction.x;
+        uint8_t  y = instruction.y;
+        uint8_t  nn = instruction.nn;
+        uint16_t nnn = instruction.nnn;
+        int32_t  next = address + 2;
+        int32_t  skip = address + 4;
+
+        switch (type)
+        {
+            case eOpcode::opcode_0E00:
+                return "            context.display->clear_pixels();\n";
+            case eOpcode::opcode_00EE:
+                return format("            {\n"
+                              "                uint16_t return_address = 0x%04x;\n"
+                              "                context.ram->pop_from_stack(&return_address);\n"
+                              "                return return_address;\n"
+                              "            }\n",
+                              next);
+            case eOpcode::opcode_1NNN:
+                return format("            return 0x%04x;\n", nnn);
+            case eOpcode::opcode_2NNN:
+                return format("            context.ram->push_to_stack(0x%04x);\n            return 0x%04x;\n", next, nnn);
+            case eOpcode::opcode_3XNN:
+                return format("            return v[0x%x] == 0x%02x ? 0x%04x : 0x%04x;\n", x, nn, skip, next);
+            case eOpcode::opcode_4XNN:
+                return format("            return v[0x%x] != 0x%02x ? 0x%04x : 0x%04x;\n", x, nn, skip, next);
+            case eOpcode::opcode_5XY0:
+                return format("            return v[0x%x] == v[0x%x] ? 0x%04x : 0x%04x;\n", x, y, skip, next);
+            case eOpcode::opcode_6XNN:
+                return format("            v[0x%x] = 0x%02x;\n", x, nn);
+            case eOpcode::opcode_7XNN:
+                return format("            v[0x%x] += 0x%02x;\n", x, nn);
+            case eOpcode::opcode_8XY0:
+                return format("            v[0x%x] = v[0x%x];\n", x, y);
+            case eOpcode::opcode_8XY1:
+                return format("            v[0x%x] |= v[0x%x];\n", x, y);
+            case eOpcode::opcode_8XY2:
+                return format("            v[0x%x] &= v[0x%x];\n", x, y);
+            case eOpcode::opcode_8XY3:
+                return format("            v[0x%x] ^= v[0x%x];\n", x, y);
+            case eOpcode::opcode_8XY4:
+                return format("            {\n"
+                              "                uint8_t vx = v[0x%x];\n"
+                              "                uint8_t sum = vx + v[0x%x];\n"
+                              "                v[0x%x] = sum;\n"
+                              "                v[0xf] = sum < vx ? 1 : 0;\n"
+                              "            }\n",
+                              x,
+                              y,
+                              x);
+            case eOpcode::opcode_8XY5:
+                return format("            {\n"
+                              "                uint8_t vx = v[0x%x];\n"
+                              "                uint8_t vy = v[0x%x];\n"
+                              "                v[0x%x] = vx - vy;\n"
+                              "                v[0xf] = vx >= vy ? 1 : 0;\n"
+                              "            }\n",
+                              x,
+                              y,
+                              x);
+            case eOpcode::opcode_8XY6:
+                return format("            {\n"
+                              "                uint8_t vx = v[0x%x];\n"
+                              "                v[0xf] = vx & 0x01;\n"
+                              "                v[0x%x] = vx >> 1;\n"
+                              "            }\n",
+                              x,
+                              x);
+            case eOpcode::opcode_8XY7:
+                return format("            {\n"
+                              "                uint8_t vx = v[0x%x];\n"
+                              "                uint8_t vy = v[0x%x];\n"
+                              "                v[0x%x] = vy - vx;\n"
+                              "                v[0xf] = vy >= vx ? 1 : 0;\n"
+                              "            }\n",
+                              x,
+                              y,
+                              x);
+            case eOpcode::opcode_8XYE:
+                return format("            {\n"
+                              "                uint8_t vx = v[0x%x];\n"
+                              "                v[0xf] = (vx & 0x80) >> 7;\n"
+                              "                v[0x%x] = vx << 1;\n"
+                              "            }\n",
+                              x,
+                              x);
+            case eOpcode::opcode_9XY0:
+                return format("            return v[0x%x] != v[0x%x] ? 0x%04x : 0x%04x;\n", x, y, skip, next);
+            case eOpcode::opcode_ANNN:
+                return format("            i = 0x%03x;\n", nnn);
+            case eOpcode::opcode_DXYN:
+                return format("            recompiled_draw_sprite(context, 0x%x, 0x%x, 0x%x);\n", x, y, instruction.n);
+            case eOpcode::opcode_EX9E:
+                return format("            return context.keyboard->is_key_pressed(v[0x%x]) ? 0x%04x : 0x%04x;\n", x, skip, next);
+            case eOpcode::opcode_EXA1:
+                return format("            return !context.keyboard->is_key_pressed(v[0x%x]) ? 0x%04x : 0x%04x;\n", x, skip, next);
+            case eOpcode::opcode_FX07:
+                return format("            v[0x%x] = context.delay_timer->get_time();\n", x);
+            case eOpcode::opcode_FX15:
+                return format("            context.delay_timer->set_time(v[0x%x]);\n", x);
+            case eOpcode::opcode_FX18:
+                return format("            context.sound_timer->set_time(v[0x%x]);\n", x);
+            case eOpcode::opcode_FX1E:
+                return format("            i += v[0x%x];\n"
+                              "            if (i > RAM_SIZE)\n"
+                              "            {\n"
+                              "                i -= (RAM_SIZE + 1);\n"
+                              "            }\n",
+                              x);
+            case eOpcode::opcode_FX29:
+                return format("            i = context.ram->get_font_char_position(0x%x);\n", instruction.n);
+            case eOpcode::opcode_FX33:
+                return format("            {\n"
+                              "                uint8_t vx = v[0x%x];\n"
+                              "                context.ram->write(i, vx / 100);\n"
+                              "                context.ram->write(i + 1, (vx %% 100) / 10);\n"
+                              "                context.ram->write(i + 2, vx %% 10);\n"
+                              "            }\n",
+                              x);
+            case eOpcode::opcode_FX55:
+                return format("            for (int32_t r = 0; r <= 0x%x; r++)\n"
+                              "            {\n"
+                              "                context.ram->write(i + r, v[r]);\n"
+                              "            }\n",
+                              x);
+            case eOpcode::opcode_FX65:
+                return format("            for (int32_t r = 0; r <= 0x%x; r++)\n"
+                              "            {\n"
+                              "                v[r] = context.ram->read(i + r);\n"
+                              "            }\n",
+                              x);
+            default:
+                return "";
+        }
+    }
+}
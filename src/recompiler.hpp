@@ -0,0 +1,41 @@
+#ifndef CHIP8_SRC_RECOMPILERHPP
+#define CHIP8_SRC_RECOMPILERHPP
+
+#include "opcode.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace chip8
+{
+    // Statically walks a ROM's control flow from the program start and turns every reachable
+    // basic block into a C++ function for the cRecompiledRunner.
+    class cRecompiler
+    {
+      public:
+        explicit cRecompiler(std::vector<uint8_t> rom);
+
+        std::string generate(const std::string& rom_name);
+
+        int32_t get_block_count() const;
+        int32_t get_instruction_count() const;
+
+      private:
+        void find_leaders();
+        void add_leader(int32_t address, std::vector<int32_t>* worklist);
+
+        bool     is_code_address(int32_t address) const;
+        uint16_t read_opcode(int32_t address) const;
+
+        std::string generate_block(int32_t start, int32_t* end, int32_t* length);
+        std::string generate_instruction(eOpcode type, const sInstruction& instruction, int32_t address) const;
+
+        std::vector<uint8_t> _rom;
+        std::vector<bool>    _leaders; // Indexed by address.
+        int32_t              _block_count {0};
+        int32_t              _instruction_count {0};
+    };
+}
+
+#endif // CHIP8_SRC_RECOMPILERHPP
@@ -0,0 +1,152 @@
+#include "render_thread.hpp"
+
+#include <algorithm>
+
+namespace chip8
+{
+    cRenderThread::cRenderThread(int32_t height, int32_t width)
+      : _renderer(height, width)
+    {
+        int32_t words_per_row = (width + 63) / 64;
+
+        for (sFrameSlot& slot : _slots)
+        {
+            slot.rows.assign(height * words_per_row, 0U);
+        }
+    }
+
+    cRenderThread::~cRenderThread()
+    {
+        stop();
+    }
+
+    void cRenderThread::start()
+    {
+        if (_running)
+        {
+            return;
+        }
+
+        _running = true;
+        _thread = std::thread(&cRenderThread::render_loop, this);
+    }
+
+    void cRenderThread::stop()
+    {
+        if (!_running)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_wake_mutex);
+            _running = false;
+        }
+
+        _wake.notify_one();
+        _thread.join();
+    }
+
+    void cRenderThread::publish(const cDisplay& display)
+    {
+        sFrameSlot& slot = _slots[_back];
+        std::copy(display.get_rows(), display.get_rows() + slot.rows.size(), slot.rows.begin());
+        slot.published_at = tClock::now();
+
+        uint8_t previous = _middle.exchange(_back | FRESH_FRAME_BIT, std::memory_order_acq_rel);
+        _back = previous & SLOT_INDEX_MASK;
+
+        if (previous & FRESH_FRAME_BIT)
+        {
+            _dropped_frames.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        _published_frames.fetch_add(1, std::memory_order_relaxed);
+
+        // The render thread only holds the lock while checking for a frame, so this never waits on terminal output.
+        {
+            std::lock_guard<std::mutex> lock(_wake_mutex);
+        }
+
+        _wake.notify_one();
+    }
+
+    cTerminalRenderer& cRenderThread::get_renderer()
+    {
+        return _renderer;
+    }
+
+    int64_t cRenderThread::get_published_frames() const
+    {
+        return _published_frames;
+    }
+
+    int64_t cRenderThread::get_presented_frames() const
+    {
+        return _presented_frames;
+    }
+
+    int64_t cRenderThread::get_dropped_frames() const
+    {
+        return _dropped_frames;
+    }
+
+    int64_t cRenderThread::get_last_latency() const
+    {
+        return _last_latency;
+    }
+
+    int64_t cRenderThread::get_max_latency() const
+    {
+        return _max_latency;
+    }
+
+    int64_t cRenderThread::get_average_latency() const
+    {
+        int64_t presented = _presented_frames;
+        return presented > 0 ? _total_latency / presented : 0;
+    }
+
+    void cRenderThread::render_loop()
+    {
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(_wake_mutex);
+                _wake.wait(lock, [this]() { return !_running || (_middle.load(std::memory_order_acquire) & FRESH_FRAME_BIT); });
+            }
+
+            // On stop, still present the frame published last.
+            if (!take_fresh_frame())
+            {
+                if (!_running)
+                {
+                    return;
+                }
+
+                continue;
+            }
+
+            const sFrameSlot& slot = _slots[_front];
+            _renderer.render(slot.rows.data(), nullptr);
+
+            int64_t latency = std::chrono::duration_cast<std::chrono::nanoseconds>(tClock::now() - slot.published_at).count();
+            _last_latency = latency;
+            _max_latency = std::max<int64_t>(_max_latency, latency);
+            _total_latency += latency;
+            _presented_frames++;
+        }
+    }
+
+    bool cRenderThread::take_fresh_frame()
+    {
+        if (!(_middle.load(std::memory_order_acquire) & FRESH_FRAME_BIT))
+        {
+            return false;
+        }
+
+        uint8_t previous = _middle.exchange(_front, std::memory_order_acq_rel);
+        _front = previous & SLOT_INDEX_MASK;
+        return true;
+    }
+}
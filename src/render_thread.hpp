@@ -0,0 +1,85 @@
+#ifndef CHIP8_SRC_RENDERTHREADHPP
+#define CHIP8_SRC_RENDERTHREADHPP
+
+#include "display.hpp"
+#include "terminal_renderer.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace chip8
+{
+    // Presents frames on its own thread, so terminal writes never stall emulation.
+    // Frames go through a triple buffer: the emulation thread fills the back slot and swaps it with the middle one,
+    // the render thread swaps the middle slot with the front one and draws it. Neither side waits for the other,
+    // and the renderer always gets the newest complete frame. Frames replaced before being drawn count as dropped.
+    class cRenderThread
+    {
+      public:
+        cRenderThread(int32_t height, int32_t width);
+        ~cRenderThread();
+
+        cRenderThread(const cRenderThread&) = delete;
+        cRenderThread& operator=(const cRenderThread&) = delete;
+
+        void start();
+        void stop(); // Presents the last published frame before returning.
+
+        // Emulation thread side. Call at each frame boundary.
+        void publish(const cDisplay& display);
+
+        // Only change the renderer while the thread is stopped.
+        cTerminalRenderer& get_renderer();
+
+        int64_t get_published_frames() const;
+        int64_t get_presented_frames() const;
+        int64_t get_dropped_frames() const; // Published but replaced by a newer frame before being presented.
+
+        // Time from publish until the frame was written to the terminal, in nanoseconds.
+        int64_t get_last_latency() const;
+        int64_t get_max_latency() const;
+        int64_t get_average_latency() const;
+
+      private:
+        using tClock = std::chrono::steady_clock;
+
+        struct sFrameSlot
+        {
+            std::vector<uint64_t> rows;
+            tClock::time_point    published_at;
+        };
+
+        // The middle slot index carries this bit while it holds a frame the renderer has not taken yet.
+        static constexpr uint8_t FRESH_FRAME_BIT = 0b100;
+        static constexpr uint8_t SLOT_INDEX_MASK = 0b011;
+
+        void render_loop();
+        bool take_fresh_frame();
+
+        cTerminalRenderer         _renderer;
+        std::array<sFrameSlot, 3> _slots;
+        uint8_t                   _back {0U};  // Owned by the emulation thread.
+        uint8_t                   _front {2U}; // Owned by the render thread.
+        std::atomic<uint8_t>      _middle {1U};
+
+        std::thread             _thread;
+        std::atomic<bool>       _running {false};
+        std::mutex              _wake_mutex; // Only guards the sleep of the render thread, never a frame.
+        std::condition_variable _wake;
+
+        std::atomic<int64_t> _published_frames {0};
+        std::atomic<int64_t> _presented_frames {0};
+        std::atomic<int64_t> _dropped_frames {0};
+        std::atomic<int64_t> _last_latency {0};
+        std::atomic<int64_t> _max_latency {0};
+        std::atomic<int64_t> _total_latency {0};
+    };
+}
+
+#endif // CHIP8_SRC_RENDERTHREADHPP
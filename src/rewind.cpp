@@ -0,0 +1,281 @@
+#include "rewind.hpp"
+
+#include <assert.h>
+
+#include <cstring>
+
+namespace chip8
+{
+    namespace
+    {
+        constexpr int32_t STATE_SIZE = sizeof(sMachineState);
+        constexpr int32_t DELTA_RUN_HEADER = 4; // u16 bytes skipped, u16 bytes following.
+
+        static_assert(STATE_SIZE <= 0xFFFF, "Delta runs address the state with 16 bits");
+
+        void put_u16(uint8_t* cursor, uint32_t value)
+        {
+            cursor[0] = static_cast<uint8_t>(value);
+            cursor[1] = static_cast<uint8_t>(value >> 8);
+        }
+
+        uint32_t get_u16(const uint8_t* cursor)
+        {
+            return cursor[0] | (cursor[1] << 8);
+        }
+
+        // Runs of bytes that differ, XORed with the base, each after the count of equal bytes before it. A run only
+        // ends at DELTA_RUN_HEADER equal bytes, shorter gaps are cheaper to carry along. Returns the encoded size.
+        int32_t encode_delta(const uint8_t* base, const uint8_t* current, uint8_t* delta)
+        {
+            int32_t size = 0;
+            int32_t position = 0;
+            int32_t previous_end = 0;
+
+            while (position < STATE_SIZE)
+            {
+                // Most of the state is unchanged, skip it a word at a time.
+                while (position + 8 <= STATE_SIZE && std::memcmp(base + position, current + position, 8) == 0)
+                {
+                    position += 8;
+                }
+
+                while (position < STATE_SIZE && base[position] == current[position])
+                {
+                    position++;
+                }
+
+                if (position == STATE_SIZE)
+                {
+                    break;
+                }
+
+                int32_t start = position;
+                int32_t end = position;
+                int32_t equal = 0;
+
+                for (; position < STATE_SIZE && equal < DELTA_RUN_HEADER; position++)
+                {
+                    if (base[position] == current[position])
+                    {
+                        equal++;
+                    }
+                    else
+                    {
+                        equal = 0;
+                        end = position + 1;
+                    }
+                }
+
+                put_u16(delta + size, start - previous_end);
+                put_u16(delta + size + 2, end - start);
+                size += DELTA_RUN_HEADER;
+
+                for (int32_t i = start; i < end; i++)
+                {
+                    delta[size++] = base[i] ^ current[i];
+                }
+
+                previous_end = end;
+                position = end;
+            }
+
+            return size;
+        }
+
+        void apply_delta(const uint8_t* delta, int32_t size, uint8_t* state)
+        {
+            int32_t position = 0;
+
+            for (int32_t read = 0; read < size;)
+            {
+                position += get_u16(delta + read);
+                uint32_t length = get_u16(delta + read + 2);
+                read += DELTA_RUN_HEADER;
+
+                for (uint32_t i = 0; i < length; i++)
+                {
+                    state[position++] ^= delta[read++];
+                }
+            }
+        }
+    }
+
+    cRewindBuffer::cRewindBuffer(int32_t frame_capacity, int32_t keyframe_interval, int32_t frame_bytes)
+      : _frame_capacity(frame_capacity)
+      , _keyframe_interval(keyframe_interval)
+    {
+        assert(frame_capacity > 0 && keyframe_interval > 0 && frame_bytes >= 0);
+
+        // Room for every keyframe in the history, plus one being written while the oldest is still held.
+        int64_t keyframes = frame_capacity / keyframe_interval + 2;
+
+        _frames.resize(frame_capacity);
+        _arena.resize(keyframes * STATE_SIZE + static_cast<int64_t>(frame_capacity) * frame_bytes);
+        _delta.resize(2 * STATE_SIZE);
+    }
+
+    void cRewindBuffer::push(const sMachineState& state)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&state);
+
+        if (_frame_count == _frame_capacity)
+        {
+            drop_oldest_group();
+        }
+
+        if (_frame_count > 0 && _frames_since_keyframe < _keyframe_interval - 1)
+        {
+            uint32_t keyframe_offset = get_frame(_frame_count - 1).keyframe_offset;
+            int32_t  size = encode_delta(&_arena[keyframe_offset], bytes, _delta.data());
+
+            // A delta as big as the state is not worth it. Neither is dropping the keyframe it needs.
+            int64_t offset = size < STATE_SIZE ? reserve(size, true) : -1;
+            if (offset >= 0)
+            {
+                std::memcpy(&_arena[offset], _delta.data(), size);
+                append({static_cast<uint32_t>(offset), static_cast<uint32_t>(size), keyframe_offset, false});
+                return;
+            }
+        }
+
+        int64_t offset = reserve(STATE_SIZE, false);
+        std::memcpy(&_arena[offset], bytes, STATE_SIZE);
+        append({static_cast<uint32_t>(offset), STATE_SIZE, static_cast<uint32_t>(offset), true});
+    }
+
+    bool cRewindBuffer::step_back(sMachineState* state)
+    {
+        if (_frame_count < 2)
+        {
+            return false;
+        }
+
+        // Records are freed in the order they were written, so the newest one's space is simply reused.
+        const sFrame& dropped = get_frame(_frame_count - 1);
+        _head = dropped.offset;
+        _used_bytes -= dropped.size;
+        _frame_count--;
+
+        _frames_since_keyframe = 0;
+        while (!get_frame(_frame_count - 1 - _frames_since_keyframe).keyframe)
+        {
+            _frames_since_keyframe++;
+        }
+
+        restore(get_frame(_frame_count - 1), state);
+        return true;
+    }
+
+    void cRewindBuffer::clear()
+    {
+        _oldest = 0;
+        _frame_count = 0;
+        _frames_since_keyframe = 0;
+        _head = 0;
+        _used_bytes = 0;
+    }
+
+    int32_t cRewindBuffer::get_frame_count() const
+    {
+        return _frame_count;
+    }
+
+    int32_t cRewindBuffer::get_frame_capacity() const
+    {
+        return _frame_capacity;
+    }
+
+    int64_t cRewindBuffer::get_used_bytes() const
+    {
+        return _used_bytes;
+    }
+
+    int64_t cRewindBuffer::get_arena_bytes() const
+    {
+        return static_cast<int64_t>(_arena.size());
+    }
+
+    cRewindBuffer::sFrame& cRewindBuffer::get_frame(int32_t age)
+    {
+        return _frames[(_oldest + age) % _frame_capacity];
+    }
+
+    int64_t cRewindBuffer::reserve(uint32_t size, bool keep_newest_group)
+    {
+        uint32_t arena_size = static_cast<uint32_t>(_arena.size());
+        assert(size <= arena_size);
+
+        for (;;)
+        {
+            if (_frame_count == 0)
+            {
+                _head = 0;
+                return 0;
+            }
+
+            // Held records run from the oldest one's offset to _head, possibly wrapping around the end.
+            uint32_t tail = get_frame(0).offset;
+
+            if (_head > tail)
+            {
+                if (_head + size <= arena_size)
+                {
+                    return _head;
+                }
+
+                if (size <= tail)
+                {
+                    return 0;
+                }
+            }
+            else if (_head + size <= tail)
+            {
+                return _head;
+            }
+
+            // The oldest frame is always a keyframe. If it is the newest one too, there is only one group.
+            if (keep_newest_group && _frame_count - 1 - _frames_since_keyframe == 0)
+            {
+                return -1;
+            }
+
+            drop_oldest_group();
+        }
+    }
+
+    void cRewindBuffer::drop_oldest_group()
+    {
+        do
+        {
+            _used_bytes -= get_frame(0).size;
+            _oldest = (_oldest + 1) % _frame_capacity;
+            _frame_count--;
+        } while (_frame_count > 0 && !get_frame(0).keyframe);
+
+        if (_frame_count == 0)
+        {
+            clear();
+        }
+    }
+
+    void cRewindBuffer::append(const sFrame& frame)
+    {
+        get_frame(_frame_count) = frame;
+        _frame_count++;
+        _frames_since_keyframe = frame.keyframe ? 0 : _frames_since_keyframe + 1;
+        _head = frame.offset + frame.size;
+        _used_bytes += frame.size;
+    }
+
+    void cRewindBuffer::restore(const sFrame& frame, sMachineState* state) const
+    {
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(state);
+        std::memcpy(bytes, &_arena[frame.keyframe_offset], STATE_SIZE);
+
+        if (!frame.keyframe)
+        {
+            apply_delta(&_arena[frame.offset], static_cast<int32_t>(frame.size), bytes);
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef CHIP8_SRC_REWINDHPP
+#define CHIP8_SRC_REWINDHPP
+
+#include "machine_state.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace chip8
+{
+    constexpr int32_t DEFAULT_REWIND_KEYFRAME_INTERVAL = 60; // One full state per second of frames.
+    constexpr int32_t DEFAULT_REWIND_FRAME_BYTES = 256;      // Arena budget per frame on top of the keyframes.
+
+    // History of machine states, one per frame, in a fixed amount of memory. Every keyframe_interval frames a full
+    // state is kept. The frames in between are stored as the bytes that differ from that keyframe, XORed with it and
+    // run length encoded, which is usually a few dozen bytes. When the history is full, the oldest keyframe and its
+    // frames are dropped together, so it always holds between frame_capacity - keyframe_interval and frame_capacity frames.
+    class cRewindBuffer
+    {
+      public:
+        cRewindBuffer(int32_t frame_capacity, int32_t keyframe_interval = DEFAULT_REWIND_KEYFRAME_INTERVAL, int32_t frame_bytes = DEFAULT_REWIND_FRAME_BYTES);
+
+        // Records the state as the newest frame.
+        void push(const sMachineState& state);
+
+        // Drops the newest frame and writes the one before it, which becomes the newest. False if there is none.
+        bool step_back(sMachineState* state);
+
+        void clear();
+
+        int32_t get_frame_count() const;
+        int32_t get_frame_capacity() const;
+        int64_t get_used_bytes() const;  // Keyframes and deltas currently held.
+        int64_t get_arena_bytes() const; // Fixed size of the storage.
+
+      private:
+        struct sFrame
+        {
+            uint32_t offset;          // Record in the arena.
+            uint32_t size;
+            uint32_t keyframe_offset; // Keyframe the delta applies to. Same as offset for keyframes.
+            bool     keyframe;
+        };
+
+        sFrame& get_frame(int32_t age); // 0 is the oldest frame.
+        int64_t reserve(uint32_t size, bool keep_newest_group);
+        void    drop_oldest_group();
+        void    append(const sFrame& frame); // Its record is already in the arena.
+        void    restore(const sFrame& frame, sMachineState* state) const;
+
+        int32_t _frame_capacity;
+        int32_t _keyframe_interval;
+
+        std::vector<sFrame> _frames; // Ring, oldest at _oldest.
+        int32_t             _oldest {0};
+        int32_t             _frame_count {0};
+        int32_t             _frames_since_keyframe {0};
+
+        std::vector<uint8_t> _arena;    // Records in push order, wrapping around.
+        uint32_t             _head {0}; // Where the next record goes.
+        int64_t              _used_bytes {0};
+
+        std::vector<uint8_t> _delta; // Delta being encoded.
+    };
+}
+
+#endif // CHIP8_SRC_REWINDHPP
@@ -0,0 +1,65 @@
+#include "run_ahead.hpp"
+
+#include <assert.h>
+
+#include <algorithm>
+
+namespace chip8
+{
+    cRunAhead::cRunAhead(cMachine* machine, int32_t frames, int32_t instructions_per_second, bool skip_idle_loops)
+      : _machine(machine)
+      , _frames(frames)
+      , _scheduler(instructions_per_second, cScheduler::ePacing::unthrottled)
+    {
+        assert(frames > 0 && frames <= MAX_RUN_AHEAD_FRAMES);
+        _scheduler.set_idle_skipping(skip_idle_loops);
+    }
+
+    void cRunAhead::run(const std::function<void(const cDisplay&)>& present)
+    {
+        tClock::time_point start = tClock::now();
+        cKeyboard*         keyboard = _machine->get_keyboard();
+
+        // Keys pressed up to now are part of the saved state. Later ones stay queued for the real frames.
+        keyboard->poll_events();
+        keyboard->set_event_polling(false);
+        _machine->save_snapshot(&_saved);
+
+        _scheduler.run_frames(_frames,
+                              _machine->get_processor(),
+                              _machine->get_ram(),
+                              _machine->get_display(),
+                              keyboard,
+                              _machine->get_delay_timer(),
+                              _machine->get_sound_timer());
+        present(*_machine->get_display());
+
+        _machine->load_snapshot(_saved);
+        keyboard->set_event_polling(true);
+
+        _last_run_time = std::chrono::duration_cast<std::chrono::nanoseconds>(tClock::now() - start).count();
+        _max_run_time = std::max(_max_run_time, _last_run_time);
+        _total_run_time += _last_run_time;
+        _runs++;
+    }
+
+    int32_t cRunAhead::get_frames() const
+    {
+        return _frames;
+    }
+
+    int64_t cRunAhead::get_last_run_time() const
+    {
+        return _last_run_time;
+    }
+
+    int64_t cRunAhead::get_max_run_time() const
+    {
+        return _max_run_time;
+    }
+
+    double cRunAhead::get_average_run_time() const
+    {
+        return _runs > 0 ? static_cast<double>(_total_run_time) / _runs : 0.0;
+    }
+}
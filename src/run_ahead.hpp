@@ -0,0 +1,45 @@
+#ifndef CHIP8_SRC_RUNAHEADHPP
+#define CHIP8_SRC_RUNAHEADHPP
+
+#include "machine.hpp"
+#include "scheduler.hpp"
+
+#include <cstdint>
+#include <functional>
+
+namespace chip8
+{
+    constexpr int32_t MAX_RUN_AHEAD_FRAMES = 8;
+
+    // Hides the frames a ROM takes to react to input. After every emulated frame the machine is saved, run a few
+    // frames further with the keys as they are now, shown in that future state and put back. A key press therefore
+    // shows up that many frames sooner. Costs that many extra frames of emulation per host frame.
+    class cRunAhead
+    {
+      public:
+        cRunAhead(cMachine* machine, int32_t frames, int32_t instructions_per_second, bool skip_idle_loops);
+
+        // Call from the frame listener of the scheduler driving the machine. present gets the display of the frame ahead.
+        void run(const std::function<void(const cDisplay&)>& present);
+
+        int32_t get_frames() const;
+        int64_t get_last_run_time() const; // Nanoseconds the last run took, presentation included.
+        int64_t get_max_run_time() const;
+        double  get_average_run_time() const;
+
+      private:
+        using tClock = std::chrono::steady_clock;
+
+        cMachine*     _machine;
+        int32_t       _frames;
+        cScheduler    _scheduler; // Unthrottled, runs the frames ahead.
+        sMachineState _saved;
+
+        int64_t _runs {0};
+        int64_t _last_run_time {0};
+        int64_t _max_run_time {0};
+        int64_t _total_run_time {0};
+    };
+}
+
+#endif // CHIP8_SRC_RUNAHEADHPP
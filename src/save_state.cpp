@@ -0,0 +1,287 @@
+#include "save_state.hpp"
+
+#include "keyboard.hpp"
+#include "machine_state.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+namespace chip8
+{
+    namespace
+    {
+        constexpr uint8_t  SAVE_STATE_MAGIC[4] = {'C', '8', 'S', 'S'};
+        constexpr uint32_t FNV_OFFSET_BASIS = 0x811C9DC5U;
+        constexpr uint32_t FNV_PRIME = 0x01000193U;
+
+        uint32_t hash_body(const uint8_t* body, int32_t size)
+        {
+            uint32_t hash = FNV_OFFSET_BASIS;
+
+            for (int32_t i = 0; i < size; i++)
+            {
+                hash = (hash ^ body[i]) * FNV_PRIME;
+            }
+
+            return hash;
+        }
+
+        // Little endian regardless of the host.
+        class cWriter
+        {
+          public:
+            explicit cWriter(uint8_t* cursor)
+              : _cursor(cursor)
+            {
+            }
+
+            void put(uint64_t value, int32_t bytes)
+            {
+                for (int32_t i = 0; i < bytes; i++)
+                {
+                    *_cursor++ = static_cast<uint8_t>(value >> (8 * i));
+                }
+            }
+
+            void put_bytes(const uint8_t* bytes, int32_t count)
+            {
+                std::memcpy(_cursor, bytes, count);
+                _cursor += count;
+            }
+
+          private:
+            uint8_t* _cursor;
+        };
+
+        class cReader
+        {
+          public:
+            explicit cReader(const uint8_t* cursor)
+              : _cursor(cursor)
+            {
+            }
+
+            uint64_t get(int32_t bytes)
+            {
+                uint64_t value = 0U;
+
+                for (int32_t i = 0; i < bytes; i++)
+                {
+                    value |= static_cast<uint64_t>(*_cursor++) << (8 * i);
+                }
+
+                return value;
+            }
+
+            void get_bytes(uint8_t* bytes, int32_t count)
+            {
+                std::memcpy(bytes, _cursor, count);
+                _cursor += count;
+            }
+
+          private:
+            const uint8_t* _cursor;
+        };
+
+        int32_t get_save_state_size(int32_t stack_entries)
+        {
+            return SAVE_STATE_HEADER_SIZE + SAVE_STATE_FIXED_SIZE + stack_entries * 2;
+        }
+
+        void write_body(const sMachineState& state, uint8_t* body)
+        {
+            cWriter writer {body};
+
+            writer.put_bytes(state.registers, REGISTER_COUNT);
+            writer.put(state.register_i, 2);
+            writer.put(state.program_counter, 2);
+            writer.put(state.delay_time, 1);
+            writer.put(state.sound_time, 1);
+            writer.put(state.waiting_for_key, 1);
+            writer.put(state.key_register, 1);
+
+            writer.put(state.key_state, 2);
+            writer.put(static_cast<uint8_t>(state.pending_press), 1);
+
+            writer.put(state.random_seed, 8);
+            writer.put(state.random_state, 8);
+
+            for (int32_t i = 0; i < state.stack_pointer; i++)
+            {
+                writer.put(state.stack[i], 2);
+            }
+
+            for (uint64_t word : state.rows)
+            {
+                writer.put(word, 8);
+            }
+
+            writer.put_bytes(state.ram, RAM_SIZE);
+        }
+
+        bool read_body(const uint8_t* body, int32_t stack_entries, sMachineState* state)
+        {
+            cReader reader {body};
+
+            reader.get_bytes(state->registers, REGISTER_COUNT);
+            state->register_i = static_cast<uint16_t>(reader.get(2));
+            state->program_counter = static_cast<uint16_t>(reader.get(2));
+            state->delay_time = static_cast<uint8_t>(reader.get(1));
+            state->sound_time = static_cast<uint8_t>(reader.get(1));
+            state->waiting_for_key = static_cast<uint8_t>(reader.get(1));
+            state->key_register = static_cast<uint8_t>(reader.get(1));
+
+            state->key_state = static_cast<uint16_t>(reader.get(2));
+            state->pending_press = static_cast<int8_t>(reader.get(1));
+
+            state->random_seed = reader.get(8);
+            state->random_state = reader.get(8);
+
+            state->stack_pointer = stack_entries;
+            for (int32_t i = 0; i < MAX_STACK_DEPTH; i++)
+            {
+                state->stack[i] = i < stack_entries ? static_cast<uint16_t>(reader.get(2)) : 0U;
+            }
+
+            for (uint64_t& word : state->rows)
+            {
+                word = reader.get(8);
+            }
+
+            reader.get_bytes(state->ram, RAM_SIZE);
+
+            return state->program_counter < RAM_SIZE && state->waiting_for_key <= 1U && state->key_register < REGISTER_COUNT &&
+                   state->pending_press >= -1 && state->pending_press < KEY_COUNT;
+        }
+    }
+
+    int32_t save_state(const sMachineState& state, uint8_t* buffer, int32_t capacity)
+    {
+        int32_t size = get_save_state_size(state.stack_pointer);
+        if (capacity < size)
+        {
+            return -1;
+        }
+
+        uint8_t* body = buffer + SAVE_STATE_HEADER_SIZE;
+        int32_t  body_size = size - SAVE_STATE_HEADER_SIZE;
+        write_body(state, body);
+
+        cWriter header {buffer};
+        header.put_bytes(SAVE_STATE_MAGIC, sizeof(SAVE_STATE_MAGIC));
+        header.put(SAVE_STATE_VERSION, 2);
+        header.put(static_cast<uint16_t>(state.stack_pointer), 2);
+        header.put(static_cast<uint32_t>(body_size), 4);
+        header.put(hash_body(body, body_size), 4);
+
+        return size;
+    }
+
+    int32_t load_state(const uint8_t* buffer, int32_t size, sMachineState* state)
+    {
+        if (size < SAVE_STATE_HEADER_SIZE || !is_save_state(buffer, size))
+        {
+            return -1;
+        }
+
+        cReader header {buffer + sizeof(SAVE_STATE_MAGIC)};
+        uint16_t version = static_cast<uint16_t>(header.get(2));
+        int32_t  stack_entries = static_cast<int32_t>(header.get(2));
+        uint32_t body_size = static_cast<uint32_t>(header.get(4));
+        uint32_t body_hash = static_cast<uint32_t>(header.get(4));
+
+        if (version != SAVE_STATE_VERSION || stack_entries > MAX_STACK_DEPTH)
+        {
+            return -1;
+        }
+
+        int32_t total_size = get_save_state_size(stack_entries);
+        if (body_size != static_cast<uint32_t>(total_size - SAVE_STATE_HEADER_SIZE) || size < total_size)
+        {
+            return -1;
+        }
+
+        const uint8_t* body = buffer + SAVE_STATE_HEADER_SIZE;
+        if (hash_body(body, static_cast<int32_t>(body_size)) != body_hash)
+        {
+            return -1;
+        }
+
+        // Parsed aside, so a bad state leaves the given one untouched.
+        sMachineState loaded;
+        if (!read_body(body, stack_entries, &loaded))
+        {
+            return -1;
+        }
+
+        *state = loaded;
+        return total_size;
+    }
+
+    bool is_save_state(const uint8_t* buffer, int32_t size)
+    {
+        return size >= static_cast<int32_t>(sizeof(SAVE_STATE_MAGIC)) && std::memcmp(buffer, SAVE_STATE_MAGIC, sizeof(SAVE_STATE_MAGIC)) == 0;
+    }
+
+    int32_t save_state_file(const sMachineState& state, const std::string& path)
+    {
+        int32_t size = get_save_state_size(state.stack_pointer);
+
+        int file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (file < 0)
+        {
+            return -1;
+        }
+
+        if (ftruncate(file, size) != 0)
+        {
+            close(file);
+            return -1;
+        }
+
+        void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+        close(file);
+
+        if (mapping == MAP_FAILED)
+        {
+            return -1;
+        }
+
+        save_state(state, static_cast<uint8_t*>(mapping), size);
+        munmap(mapping, size);
+        return 0;
+    }
+
+    int32_t load_state_file(const std::string& path, sMachineState* state)
+    {
+        int file = open(path.c_str(), O_RDONLY);
+        if (file < 0)
+        {
+            return -1;
+        }
+
+        struct stat status;
+        if (fstat(file, &status) != 0 || status.st_size <= 0 || status.st_size > MAX_SAVE_STATE_SIZE)
+        {
+            close(file);
+            return -1;
+        }
+
+        int32_t size = static_cast<int32_t>(status.st_size);
+        void*   mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+
+        if (mapping == MAP_FAILED)
+        {
+            return -1;
+        }
+
+        int32_t loaded = load_state(static_cast<const uint8_t*>(mapping), size, state);
+        munmap(mapping, size);
+        return loaded < 0 ? -1 : 0;
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef CHIP8_SRC_SAVESTATEHPP
+#define CHIP8_SRC_SAVESTATEHPP
+
+#include "display.hpp"
+#include "processor.hpp"
+#include "ram.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace chip8
+{
+    struct sMachineState;
+
+    // Save states are a 16 byte header followed by the fields of sMachineState, packed and little endian:
+    //   header    "C8SS", u16 version, u16 stack entries, u32 body size, u32 FNV-1a of the body
+    //   cpu       V0-VF, u16 I, u16 PC, u8 delay, u8 sound, u8 waiting for key, u8 key register
+    //   keyboard  u16 key state, i8 pending press
+    //   random    u64 seed, u64 generator state
+    //   stack     u16 per entry in use, bottom first
+    //   display   u64 per framebuffer word, see cDisplay
+    //   ram       RAM_SIZE bytes
+    // Loading checks everything it can, a state that loads is one the machine could have reached.
+    constexpr uint16_t SAVE_STATE_VERSION = 1;
+    constexpr int32_t  SAVE_STATE_HEADER_SIZE = 16;
+    constexpr int32_t  SAVE_STATE_FIXED_SIZE = REGISTER_COUNT + 8 + 3 + 16 + DISPLAY_HEIGHT * DISPLAY_WORDS_PER_ROW * 8 + RAM_SIZE;
+    constexpr int32_t  MAX_SAVE_STATE_SIZE = SAVE_STATE_HEADER_SIZE + SAVE_STATE_FIXED_SIZE + MAX_STACK_DEPTH * 2;
+
+    // Returns the bytes written, or -1 if capacity is too small. MAX_SAVE_STATE_SIZE is always enough.
+    int32_t save_state(const sMachineState& state, uint8_t* buffer, int32_t capacity);
+
+    // Returns the bytes read, or -1 if the buffer does not hold a valid save state of this version.
+    // state is only written to on success.
+    int32_t load_state(const uint8_t* buffer, int32_t size, sMachineState* state);
+
+    // True if the buffer starts like a save state, to tell them apart from ROMs.
+    bool is_save_state(const uint8_t* buffer, int32_t size);
+
+    // Same, through a memory mapping of the file. Return 0 on success and -1 on any error.
+    int32_t save_state_file(const sMachineState& state, const std::string& path);
+    int32_t load_state_file(const std::string& path, sMachineState* state);
+}
+
+#endif // CHIP8_SRC_SAVESTATEHPP
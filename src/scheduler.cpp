@@ -0,0 +1,207 @@
+#include "scheduler.hpp"
+
+#include "processor.hpp"
+#include "timer.hpp"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+namespace chip8
+{
+    namespace
+    {
+        // Falling further behind than this (a debugger break, a suspended terminal) restarts pacing
+        // instead of running flat out until emulated time catches up.
+        constexpr std::chrono::milliseconds MAX_PACING_LAG {250};
+    }
+
+    cScheduler::cScheduler(int32_t instructions_per_second, ePacing pacing)
+      : _instructions_per_second(instructions_per_second)
+      , _pacing(pacing)
+    {
+        assert(_instructions_per_second > 0);
+    }
+
+    int64_t cScheduler::run_cycles(int64_t cycles, cProcessor* processor, cRam* ram, cDisplay* display, cKeyboard* keyboard, cTimer* delay_timer, cTimer* sound_timer)
+    {
+        return run(cycles, std::numeric_limits<int64_t>::max(), processor, ram, display, keyboard, delay_timer, sound_timer);
+    }
+
+    int64_t cScheduler::run_frames(int64_t frames, cProcessor* processor, cRam* ram, cDisplay* display, cKeyboard* keyboard, cTimer* delay_timer, cTimer* sound_timer)
+    {
+        return run(std::numeric_limits<int64_t>::max(), frames, processor, ram, display, keyboard, delay_timer, sound_timer);
+    }
+
+    void cScheduler::set_frame_listener(tFrameListener listener)
+    {
+        _frame_listener = std::move(listener);
+    }
+
+    void cScheduler::request_stop()
+    {
+        _stop_requested = true;
+    }
+
+    void cScheduler::set_idle_skipping(bool enabled)
+    {
+        _skip_idle_loops = enabled;
+    }
+
+    int32_t cScheduler::get_instructions_per_second() const
+    {
+        return _instructions_per_second;
+    }
+
+    cScheduler::ePacing cScheduler::get_pacing() const
+    {
+        return _pacing;
+    }
+
+    int64_t cScheduler::get_executed() const
+    {
+        return _executed;
+    }
+
+    int64_t cScheduler::get_frames() const
+    {
+        return _frames;
+    }
+
+    int64_t cScheduler::get_idle_cycles() const
+    {
+        return _idle_cycles;
+    }
+
+    int64_t cScheduler::get_halted_cycles() const
+    {
+        return _halted_cycles;
+    }
+
+    int64_t cScheduler::run(int64_t     cycle_limit,
+                            int64_t     frame_limit,
+                            cProcessor* processor,
+                            cRam*       ram,
+                            cDisplay*   display,
+                            cKeyboard*  keyboard,
+                            cTimer*     delay_timer,
+                            cTimer*     sound_timer)
+    {
+        int64_t executed = 0;
+        int64_t frames = 0;
+        _stop_requested = false;
+
+        if (_pacing == ePacing::real_time)
+        {
+            _frame_work_start = tClock::now();
+
+            if (!_pacing_started)
+            {
+                _pacing_origin = _frame_work_start;
+                _pacing_origin_frame = _frames;
+                _pacing_started = true;
+            }
+        }
+
+        while (executed < cycle_limit && frames < frame_limit && !_stop_requested)
+        {
+            // Instructions left until the next tick, rounded up.
+            int64_t until_tick = (_instructions_per_second - _tick_accumulator + TIMER_FREQUENCY - 1) / TIMER_FREQUENCY;
+            int32_t batch = static_cast<int32_t>(std::min(until_tick, cycle_limit - executed));
+
+            int32_t batch_executed = 0;
+            if (_skip_idle_loops)
+            {
+                batch_executed = processor->skip_idle_loop(batch, ram, display, keyboard, delay_timer, sound_timer);
+                _idle_cycles += batch_executed;
+            }
+
+            batch_executed += processor->run_cycles(batch - batch_executed, ram, display, keyboard, delay_timer, sound_timer);
+
+            // A processor halted on FX0A spends the rest of the batch waiting. Time goes on for the timers.
+            if (processor->is_waiting_for_key())
+            {
+                _halted_cycles += batch - batch_executed;
+                batch_executed = batch;
+            }
+            executed += batch_executed;
+            _executed += batch_executed;
+            _tick_accumulator += static_cast<int64_t>(batch_executed) * TIMER_FREQUENCY;
+
+            while (_tick_accumulator >= _instructions_per_second)
+            {
+                _tick_accumulator -= _instructions_per_second;
+                delay_timer->update();
+                sound_timer->update();
+                _frames++;
+                frames++;
+
+                if (_pacing == ePacing::real_time)
+                {
+                    measure_frame_work();
+                    wait_for_frame();
+                    _frame_work_start = tClock::now();
+                }
+
+                if (_frame_listener)
+                {
+                    _frame_listener();
+                }
+            }
+        }
+
+        return executed;
+    }
+
+    int64_t cScheduler::get_last_frame_work() const
+    {
+        return _last_frame_work;
+    }
+
+    int64_t cScheduler::get_max_frame_work() const
+    {
+        return _max_frame_work;
+    }
+
+    double cScheduler::get_average_frame_work() const
+    {
+        return _measured_frames > 0 ? static_cast<double>(_total_frame_work) / _measured_frames : 0.0;
+    }
+
+    int64_t cScheduler::get_frames_over_budget() const
+    {
+        return _frames_over_budget;
+    }
+
+    void cScheduler::measure_frame_work()
+    {
+        _last_frame_work = std::chrono::duration_cast<std::chrono::nanoseconds>(tClock::now() - _frame_work_start).count();
+        _max_frame_work = std::max(_max_frame_work, _last_frame_work);
+        _total_frame_work += _last_frame_work;
+        _measured_frames++;
+
+        if (_last_frame_work > 1000000000LL / TIMER_FREQUENCY)
+        {
+            _frames_over_budget++;
+        }
+    }
+
+    void cScheduler::wait_for_frame()
+    {
+        int64_t           frames_since_origin = _frames - _pacing_origin_frame;
+        tClock::time_point deadline = _pacing_origin + std::chrono::nanoseconds(frames_since_origin * 1000000000LL / TIMER_FREQUENCY);
+        tClock::time_point now = tClock::now();
+
+        if (now < deadline)
+        {
+            std::this_thread::sleep_until(deadline);
+        }
+        else if (now - deadline > MAX_PACING_LAG)
+        {
+            _pacing_origin = now;
+            _pacing_origin_frame = _frames;
+        }
+    }
+}
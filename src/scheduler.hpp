@@ -0,0 +1,99 @@
+#ifndef CHIP8_SRC_SCHEDULERHPP
+#define CHIP8_SRC_SCHEDULERHPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace chip8
+{
+    constexpr int32_t DEFAULT_INSTRUCTIONS_PER_SECOND = 720;
+    constexpr int32_t TIMER_FREQUENCY = 60;
+
+    class cDisplay;
+    class cKeyboard;
+    class cProcessor;
+    class cRam;
+    class cTimer;
+
+    // Runs the processor at a fixed number of instructions per second of emulated time and ticks the
+    // delay and sound timers at exactly 60 Hz of that same time. Instructions run in batches that end
+    // on timer ticks, so the hot loop only checks for a tick once per batch.
+    class cScheduler
+    {
+      public:
+        enum class ePacing
+        {
+            real_time,   // Emulated time follows the host's monotonic clock.
+            unthrottled, // As fast as the host allows.
+        };
+
+        // Called after every timer tick, once the frame it ends is due.
+        using tFrameListener = std::function<void()>;
+
+        cScheduler(int32_t instructions_per_second, ePacing pacing);
+
+        // Runs until either limit is reached. All three return the cycles of emulated time that passed, each cycle
+        // being one instruction's worth. Cycles spent skipping idle loops or halted on FX0A count as well.
+        int64_t run(int64_t cycle_limit, int64_t frame_limit, cProcessor* processor, cRam* ram, cDisplay* display, cKeyboard* keyboard, cTimer* delay_timer, cTimer* sound_timer);
+        int64_t run_cycles(int64_t cycles, cProcessor* processor, cRam* ram, cDisplay* display, cKeyboard* keyboard, cTimer* delay_timer, cTimer* sound_timer);
+        int64_t run_frames(int64_t frames, cProcessor* processor, cRam* ram, cDisplay* display, cKeyboard* keyboard, cTimer* delay_timer, cTimer* sound_timer);
+
+        void set_frame_listener(tFrameListener listener);
+
+        // Makes the current run return at the end of its batch. Meant to be called from the frame listener.
+        void request_stop();
+
+        // Lets the processor skip over loops that only wait for the delay timer or a key. On by default.
+        void set_idle_skipping(bool enabled);
+
+        int32_t get_instructions_per_second() const;
+        ePacing get_pacing() const;
+        int64_t get_executed() const;      // Cycles since construction.
+        int64_t get_frames() const;        // Timer ticks since construction.
+        int64_t get_idle_cycles() const;   // Part of get_executed() covered by idle loop skipping.
+        int64_t get_halted_cycles() const; // Part of get_executed() spent waiting for a key.
+
+        // Real time pacing only. Host time a frame took, in nanoseconds: the frame listener call before it and its
+        // instructions, without the wait for its deadline. Frames over budget took longer than 1 / TIMER_FREQUENCY.
+        int64_t get_last_frame_work() const;
+        int64_t get_max_frame_work() const;
+        double  get_average_frame_work() const;
+        int64_t get_frames_over_budget() const;
+
+      private:
+        using tClock = std::chrono::steady_clock;
+
+        void measure_frame_work();
+        void wait_for_frame();
+
+        int32_t _instructions_per_second;
+        ePacing _pacing;
+
+        // Emulated time since the last tick, counted in 1 / (instructions_per_second * 60) seconds.
+        // An instruction adds 60, a tick takes instructions_per_second. Integers keep it from drifting.
+        int64_t _tick_accumulator {0};
+        int64_t _executed {0};
+        int64_t _frames {0};
+        int64_t _idle_cycles {0};
+        int64_t _halted_cycles {0};
+        bool    _skip_idle_loops {true};
+        bool    _stop_requested {false};
+
+        // Real time pacing. Deadlines are computed from the origin rather than accumulated.
+        bool              _pacing_started {false};
+        tClock::time_point _pacing_origin {};
+        int64_t           _pacing_origin_frame {0};
+
+        tClock::time_point _frame_work_start {};
+        int64_t           _last_frame_work {0};
+        int64_t           _max_frame_work {0};
+        int64_t           _total_frame_work {0};
+        int64_t           _measured_frames {0};
+        int64_t           _frames_over_budget {0};
+
+        tFrameListener _frame_listener;
+    };
+}
+
+#endif // CHIP8_SRC_SCHEDULERHPP
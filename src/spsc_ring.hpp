@@ -0,0 +1,59 @@
+#ifndef CHIP8_SRC_SPSCRINGHPP
+#define CHIP8_SRC_SPSCRINGHPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace chip8
+{
+    // Fixed size queue for exactly one producer thread and one consumer thread. Neither side locks or allocates.
+    template <typename T, size_t CAPACITY>
+    class cSpscRing
+    {
+        static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "Capacity must be a power of two");
+
+      public:
+        // Producer side. False when the queue is full.
+        bool push(const T& value)
+        {
+            size_t head = _head.load(std::memory_order_relaxed);
+            if (head - _tail.load(std::memory_order_acquire) == CAPACITY)
+            {
+                return false;
+            }
+
+            _items[head & (CAPACITY - 1)] = value;
+            _head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side. False when the queue is empty.
+        bool pop(T* value)
+        {
+            size_t tail = _tail.load(std::memory_order_relaxed);
+            if (tail == _head.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+
+            *value = _items[tail & (CAPACITY - 1)];
+            _tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side.
+        bool empty() const
+        {
+            return _tail.load(std::memory_order_relaxed) == _head.load(std::memory_order_acquire);
+        }
+
+      private:
+        // Each index on its own cache line so the two threads do not fight over it.
+        alignas(64) std::atomic<size_t> _head {0U};
+        alignas(64) std::atomic<size_t> _tail {0U};
+        std::array<T, CAPACITY> _items {};
+    };
+}
+
+#endif // CHIP8_SRC_SPSCRINGHPP
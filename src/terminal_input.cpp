@@ -0,0 +1,246 @@
+#include "terminal_input.hpp"
+
+#include "keyboard.hpp"
+
+#include <csignal>
+#include <cstdlib>
+
+#include <poll.h>
+#include <unistd.h>
+
+namespace chip8
+{
+    namespace
+    {
+        constexpr char ESCAPE_KEY = 0x1B;
+        constexpr char BACKSPACE_KEY = 0x7F;
+        constexpr char CONTROL_H_KEY = 0x08; // Backspace on some terminals.
+        constexpr int  POLL_TIMEOUT_MS = 10;
+
+        // Arrow and function keys arrive as ESC [ ... or ESC O x. An escape with nothing after it for this long was pressed on its own.
+        constexpr std::chrono::milliseconds LONE_ESCAPE_TIME {50};
+
+        enum class eEscapeState
+        {
+            none,
+            escape,  // ESC seen, waiting to see whether a sequence follows.
+            csi,     // ESC [, runs up to a final byte in 0x40 to 0x7E.
+            ss3      // ESC O, one more byte.
+        };
+
+        eEscapeState advance_escape(eEscapeState state, char byte)
+        {
+            switch (state)
+            {
+                case eEscapeState::none:
+                    return byte == ESCAPE_KEY ? eEscapeState::escape : eEscapeState::none;
+                case eEscapeState::escape:
+                    if (byte == '[')
+                    {
+                        return eEscapeState::csi;
+                    }
+
+                    if (byte == 'O')
+                    {
+                        return eEscapeState::ss3;
+                    }
+
+                    // Alt plus a key, dropped. A second escape starts over.
+                    return byte == ESCAPE_KEY ? eEscapeState::escape : eEscapeState::none;
+                case eEscapeState::csi:
+                    return byte >= 0x40 && byte <= 0x7E ? eEscapeState::none : eEscapeState::csi;
+                case eEscapeState::ss3:
+                    return eEscapeState::none;
+            }
+
+            return eEscapeState::none;
+        }
+
+        // Raw mode keeps signals enabled, so Ctrl+C and kill have to put the terminal back themselves.
+        // Only one cTerminalInput reads the terminal at a time.
+        termios               raw_saved_terminal {};
+        volatile sig_atomic_t raw_mode_active = 0;
+        struct sigaction      saved_interrupt_action {};
+        struct sigaction      saved_terminate_action {};
+
+        void restore_terminal()
+        {
+            if (raw_mode_active)
+            {
+                tcsetattr(STDIN_FILENO, TCSANOW, &raw_saved_terminal);
+                raw_mode_active = 0;
+            }
+        }
+
+        void handle_signal(int signal_number)
+        {
+            restore_terminal();
+
+            // Hand the signal to whatever was installed before, usually the default that ends the process.
+            sigaction(signal_number, signal_number == SIGINT ? &saved_interrupt_action : &saved_terminate_action, nullptr);
+            raise(signal_number);
+        }
+
+        // Host key for every CHIP-8 key, indexed by key id.
+        constexpr char HOST_KEYS[KEY_COUNT + 1] = "x123qweasdzc4rfv";
+    }
+
+    cTerminalInput::cTerminalInput(cKeyboard* keyboard)
+      : _keyboard(keyboard)
+    {
+    }
+
+    cTerminalInput::~cTerminalInput()
+    {
+        stop();
+    }
+
+    bool cTerminalInput::start()
+    {
+        if (_running || !isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &_saved_terminal) != 0)
+        {
+            return false;
+        }
+
+        // No line buffering and no echo. Signals stay enabled so Ctrl+C still works.
+        termios raw = _saved_terminal;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 0;
+        raw.c_cc[VTIME] = 0;
+        raw_saved_terminal = _saved_terminal;
+        raw_mode_active = 1;
+
+        static bool exit_hook_registered = false;
+        if (!exit_hook_registered)
+        {
+            std::atexit(restore_terminal);
+            exit_hook_registered = true;
+        }
+
+        struct sigaction action {};
+        action.sa_handler = handle_signal;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, &saved_interrupt_action);
+        sigaction(SIGTERM, &action, &saved_terminate_action);
+
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+
+        _running = true;
+        _thread = std::thread(&cTerminalInput::read_loop, this);
+        return true;
+    }
+
+    void cTerminalInput::stop()
+    {
+        if (!_running)
+        {
+            return;
+        }
+
+        _running = false;
+        _thread.join();
+
+        sigaction(SIGINT, &saved_interrupt_action, nullptr);
+        sigaction(SIGTERM, &saved_terminate_action, nullptr);
+        restore_terminal();
+    }
+
+    bool cTerminalInput::is_quit_requested() const
+    {
+        return _quit_requested;
+    }
+
+    bool cTerminalInput::is_rewind_held() const
+    {
+        int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(tClock::now().time_since_epoch()).count();
+        return now - _rewind_seen_at < std::chrono::duration_cast<std::chrono::nanoseconds>(KEY_HOLD_TIME).count();
+    }
+
+    int8_t cTerminalInput::map_host_key(char host_key)
+    {
+        for (int8_t key_id = 0; key_id < KEY_COUNT; key_id++)
+        {
+            if (HOST_KEYS[key_id] == host_key)
+            {
+                return key_id;
+            }
+        }
+
+        return -1;
+    }
+
+    void cTerminalInput::read_loop()
+    {
+        pollfd input {STDIN_FILENO, POLLIN, 0};
+        char   buffer[32];
+
+        eEscapeState       escape_state = eEscapeState::none;
+        tClock::time_point escape_seen_at {};
+
+        while (_running)
+        {
+            if (poll(&input, 1, POLL_TIMEOUT_MS) > 0 && (input.revents & POLLIN))
+            {
+                ssize_t count = read(STDIN_FILENO, buffer, sizeof(buffer));
+                tClock::time_point now = tClock::now();
+
+                for (ssize_t i = 0; i < count; i++)
+                {
+                    if (escape_state != eEscapeState::none || buffer[i] == ESCAPE_KEY)
+                    {
+                        if (escape_state == eEscapeState::escape && buffer[i] == ESCAPE_KEY)
+                        {
+                            _quit_requested = true; // The first of two escapes was on its own.
+                        }
+
+                        escape_state = advance_escape(escape_state, buffer[i]);
+                        escape_seen_at = now;
+                        continue;
+                    }
+
+                    if (buffer[i] == BACKSPACE_KEY || buffer[i] == CONTROL_H_KEY)
+                    {
+                        _rewind_seen_at = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+                        continue;
+                    }
+
+                    int8_t key_id = map_host_key(buffer[i]);
+                    if (key_id < 0)
+                    {
+                        continue;
+                    }
+
+                    // Auto repeat keeps a held key alive without pressing it again.
+                    if (!((_held_keys >> key_id) & 0b1) && _keyboard->press_key(static_cast<uint8_t>(key_id)))
+                    {
+                        _held_keys |= 1U << key_id;
+                    }
+
+                    _last_seen[key_id] = now;
+                }
+            }
+
+            if (escape_state == eEscapeState::escape && tClock::now() - escape_seen_at >= LONE_ESCAPE_TIME)
+            {
+                _quit_requested = true;
+                escape_state = eEscapeState::none;
+            }
+
+            release_stale_keys(tClock::now(), false);
+        }
+
+        release_stale_keys(tClock::now(), true);
+    }
+
+    void cTerminalInput::release_stale_keys(tClock::time_point now, bool release_all)
+    {
+        for (uint8_t key_id = 0U; key_id < KEY_COUNT; key_id++)
+        {
+            bool held = (_held_keys >> key_id) & 0b1;
+            if (held && (release_all || now - _last_seen[key_id] >= KEY_HOLD_TIME) && _keyboard->release_key(key_id))
+            {
+                _held_keys &= ~(1U << key_id);
+            }
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef CHIP8_SRC_TERMINALINPUTHPP
+#define CHIP8_SRC_TERMINALINPUTHPP
+
+#include "keyboard.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include <termios.h>
+
+namespace chip8
+{
+    // Reads the terminal in raw mode on its own thread and feeds the keyboard's event queue.
+    // Host keys map to the usual layout:
+    //   1 2 3 4      1 2 3 C
+    //   q w e r  ->  4 5 6 D
+    //   a s d f      7 8 9 E
+    //   z x c v      A 0 B F
+    // Terminals only report presses, so a key counts as released once it has not repeated for KEY_HOLD_TIME.
+    // A lone escape asks to quit, arrow and function keys are ignored. Backspace is held to rewind.
+    class cTerminalInput
+    {
+      public:
+        static constexpr std::chrono::milliseconds KEY_HOLD_TIME {150};
+
+        explicit cTerminalInput(cKeyboard* keyboard);
+        ~cTerminalInput();
+
+        cTerminalInput(const cTerminalInput&) = delete;
+        cTerminalInput& operator=(const cTerminalInput&) = delete;
+
+        // False if stdin is not a terminal.
+        bool start();
+        void stop(); // Releases every key and restores the terminal.
+
+        bool is_quit_requested() const; // A lone escape was pressed.
+        bool is_rewind_held() const;    // Backspace is down.
+
+      private:
+        using tClock = std::chrono::steady_clock;
+
+        static int8_t map_host_key(char host_key);
+
+        void read_loop();
+        void release_stale_keys(tClock::time_point now, bool release_all);
+
+        cKeyboard*                                _keyboard;
+        std::thread                               _thread;
+        std::atomic<bool>                         _running {false};
+        std::atomic<bool>                         _quit_requested {false};
+        std::atomic<int64_t>                      _rewind_seen_at {INT64_MIN / 2}; // Nanoseconds of tClock.
+        termios                                   _saved_terminal {};
+        uint16_t                                  _held_keys {0U}; // Keys the keyboard was told are down.
+        std::array<tClock::time_point, KEY_COUNT> _last_seen {};
+    };
+}
+
+#endif // CHIP8_SRC_TERMINALINPUTHPP
@@ -0,0 +1,234 @@
+#include "terminal_renderer.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace chip8
+{
+    cTerminalRenderer::cTerminalRenderer(int32_t height, int32_t width)
+      : _height(height)
+      , _width(width)
+      , _words_per_row((width + 63) / 64)
+    {
+        _presented_rows.assign(_height * _words_per_row, 0U);
+        _line_changes.assign(_words_per_row, 0U);
+    }
+
+    void cTerminalRenderer::render(const uint64_t* rows, const std::vector<uint8_t>* dirty_rows)
+    {
+        _rows = rows;
+        _dirty_rows = dirty_rows;
+        _frame_output.clear();
+
+        if (_full_redraw)
+        {
+            render_full();
+        }
+        else
+        {
+            render_changes();
+        }
+
+        std::cout.write(_frame_output.data(), static_cast<std::streamsize>(_frame_output.size()));
+        std::cout.flush();
+
+        _last_frame_bytes = static_cast<int64_t>(_frame_output.size());
+        _total_frame_bytes += _last_frame_bytes;
+        _presented_frames++;
+
+        std::copy(rows, rows + _presented_rows.size(), _presented_rows.begin());
+        _full_redraw = false;
+        _rows = nullptr;
+        _dirty_rows = nullptr;
+    }
+
+    void cTerminalRenderer::request_full_redraw()
+    {
+        _full_redraw = true;
+    }
+
+    void cTerminalRenderer::set_render_style(eRenderStyle style)
+    {
+        _render_style = style;
+        _full_redraw = true;
+    }
+
+    cTerminalRenderer::eRenderStyle cTerminalRenderer::get_render_style() const
+    {
+        return _render_style;
+    }
+
+    int64_t cTerminalRenderer::get_last_frame_bytes() const
+    {
+        return _last_frame_bytes;
+    }
+
+    int64_t cTerminalRenderer::get_total_frame_bytes() const
+    {
+        return _total_frame_bytes;
+    }
+
+    int64_t cTerminalRenderer::get_presented_frames() const
+    {
+        return _presented_frames;
+    }
+
+    int32_t cTerminalRenderer::get_line_count() const
+    {
+        return _render_style == eRenderStyle::half_block ? (_height + 1) / 2 : _height;
+    }
+
+    bool cTerminalRenderer::is_line_dirty(int32_t line) const
+    {
+        if (_dirty_rows == nullptr)
+        {
+            return true;
+        }
+
+        const std::vector<uint8_t>& dirty_rows = *_dirty_rows;
+
+        if (_render_style == eRenderStyle::ascii)
+        {
+            return dirty_rows[line] != 0U;
+        }
+
+        int32_t top = line * 2;
+        return dirty_rows[top] != 0U || (top + 1 < _height && dirty_rows[top + 1] != 0U);
+    }
+
+    bool cTerminalRenderer::get_frame_pixel(int32_t x, int32_t y) const
+    {
+        uint64_t word = _rows[y * _words_per_row + x / 64];
+        return (word >> (63 - x % 64)) & 0b1;
+    }
+
+    void cTerminalRenderer::append_cell(int32_t x, int32_t line)
+    {
+        if (_render_style == eRenderStyle::ascii)
+        {
+            _frame_output += get_frame_pixel(x, line) ? FULL_PIXEL_CHAR : EMPTY_PIXEL_CHAR;
+            return;
+        }
+
+        // An odd height leaves the bottom half of the last line empty.
+        bool top = get_frame_pixel(x, line * 2);
+        bool bottom = line * 2 + 1 < _height && get_frame_pixel(x, line * 2 + 1);
+
+        if (top && bottom)
+        {
+            _frame_output += FULL_HALF_BLOCK;
+        }
+        else if (top)
+        {
+            _frame_output += UPPER_HALF_BLOCK;
+        }
+        else if (bottom)
+        {
+            _frame_output += LOWER_HALF_BLOCK;
+        }
+        else
+        {
+            _frame_output += EMPTY_HALF_BLOCK;
+        }
+    }
+
+    void cTerminalRenderer::append_cursor_move(int32_t x, int32_t line)
+    {
+        // Terminal rows and columns start at 1.
+        _frame_output += "\e[";
+        _frame_output += std::to_string(line + 1);
+        _frame_output += ';';
+        _frame_output += std::to_string(x + 1);
+        _frame_output += 'H';
+    }
+
+    void cTerminalRenderer::render_full()
+    {
+        _frame_output += "\e[1;1H\e[2J";
+
+        int32_t line_count = get_line_count();
+        for (int32_t line = 0; line < line_count; line++)
+        {
+            for (int32_t x = 0; x < _width; x++)
+            {
+                append_cell(x, line);
+            }
+
+            _frame_output += '\n';
+        }
+    }
+
+    void cTerminalRenderer::render_changes()
+    {
+        // Unchanged cells in between are cheaper to rewrite than a cursor move, up to this many.
+        int32_t max_span_gap = _render_style == eRenderStyle::ascii ? 6 : 2;
+
+        int32_t line_count = get_line_count();
+        bool    moved_cursor = false;
+
+        for (int32_t line = 0; line < line_count; line++)
+        {
+            if (!is_line_dirty(line))
+            {
+                continue;
+            }
+
+            // Cells whose pixels differ from what the terminal shows. Half blocks cover two rows.
+            int32_t rows_per_line = _render_style == eRenderStyle::ascii ? 1 : 2;
+            std::fill(_line_changes.begin(), _line_changes.end(), 0U);
+            bool any_change = false;
+
+            for (int32_t y = line * rows_per_line; y < std::min(_height, (line + 1) * rows_per_line); y++)
+            {
+                for (int32_t w = 0; w < _words_per_row; w++)
+                {
+                    size_t index = y * _words_per_row + w;
+                    _line_changes[w] |= _rows[index] ^ _presented_rows[index];
+                    any_change |= _line_changes[w] != 0U;
+                }
+            }
+
+            if (!any_change)
+            {
+                continue;
+            }
+
+            auto is_changed = [this](int32_t x) { return (_line_changes[x / 64] >> (63 - x % 64)) & 0b1; };
+
+            int32_t x = 0;
+            while (x < _width)
+            {
+                if (!is_changed(x))
+                {
+                    x++;
+                    continue;
+                }
+
+                // Grow the span while the next change is close enough.
+                int32_t span_end = x + 1;
+                for (int32_t next = span_end; next < _width && next - span_end < max_span_gap; next++)
+                {
+                    if (is_changed(next))
+                    {
+                        span_end = next + 1;
+                    }
+                }
+
+                append_cursor_move(x, line);
+                for (int32_t cell = x; cell < span_end; cell++)
+                {
+                    append_cell(cell, line);
+                }
+
+                moved_cursor = true;
+                x = span_end;
+            }
+        }
+
+        // Park the cursor under the screen, where a full redraw leaves it.
+        if (moved_cursor)
+        {
+            append_cursor_move(0, line_count);
+        }
+    }
+}
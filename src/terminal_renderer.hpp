@@ -0,0 +1,74 @@
+#ifndef CHIP8_SRC_TERMINALRENDERERHPP
+#define CHIP8_SRC_TERMINALRENDERERHPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace chip8
+{
+    constexpr char EMPTY_PIXEL_CHAR = '.';
+    constexpr char FULL_PIXEL_CHAR = '#';
+
+    // Half block characters, each packing two pixel rows into one terminal cell.
+    constexpr const char* EMPTY_HALF_BLOCK = " ";
+    constexpr const char* UPPER_HALF_BLOCK = "\u2580";
+    constexpr const char* LOWER_HALF_BLOCK = "\u2584";
+    constexpr const char* FULL_HALF_BLOCK = "\u2588";
+
+    // Draws bit-packed frames (see cDisplay) to the terminal. Only the cells that changed since the last frame
+    // are redrawn, with cursor moves, in a single write per frame.
+    class cTerminalRenderer
+    {
+      public:
+        enum class eRenderStyle
+        {
+            ascii,      // One character per pixel.
+            half_block, // Unicode half blocks, two pixel rows per terminal line.
+        };
+
+        cTerminalRenderer(int32_t height, int32_t width);
+
+        // rows holds height * words per row words, see cDisplay::get_rows.
+        // dirty_rows flags the rows that may have changed since the last frame. Without it every row is compared.
+        void render(const uint64_t* rows, const std::vector<uint8_t>* dirty_rows);
+
+        // The next frame clears the terminal and redraws everything. Use when something else wrote over the screen.
+        void request_full_redraw();
+
+        void         set_render_style(eRenderStyle style);
+        eRenderStyle get_render_style() const;
+
+        int64_t get_last_frame_bytes() const; // Bytes the last frame wrote to the terminal.
+        int64_t get_total_frame_bytes() const;
+        int64_t get_presented_frames() const;
+
+      private:
+        int32_t get_line_count() const;
+        bool    is_line_dirty(int32_t line) const;
+        bool    get_frame_pixel(int32_t x, int32_t y) const;
+        void    append_cell(int32_t x, int32_t line);
+        void    append_cursor_move(int32_t x, int32_t line);
+        void    render_full();
+        void    render_changes();
+
+        int32_t _height;
+        int32_t _width;
+        int32_t _words_per_row;
+
+        // Frame being rendered.
+        const uint64_t*              _rows {nullptr};
+        const std::vector<uint8_t>*  _dirty_rows {nullptr};
+
+        std::vector<uint64_t> _presented_rows; // Frame as the terminal currently shows it.
+        std::vector<uint64_t> _line_changes;   // Cells of the line being rendered that differ from the terminal.
+        std::string           _frame_output;
+        eRenderStyle          _render_style {eRenderStyle::ascii};
+        bool                  _full_redraw {true};
+        int64_t               _last_frame_bytes {0};
+        int64_t               _total_frame_bytes {0};
+        int64_t               _presented_frames {0};
+    };
+}
+
+#endif // CHIP8_SRC_TERMINALRENDERERHPP
@@ -1,22 +1,26 @@
 #include "timer.hpp"
+#include "machine_state.hpp"
+
+#include <assert.h>
 
 namespace chip8
 {
-
-    cTimer::cTimer(cTimer::eType type)
+    cTimer::cTimer(cTimer::eType type, sMachineState* state)
       : _type(type)
     {
+        assert(type != eType::undefined);
+        _time = type == eType::sound ? &state->sound_time : &state->delay_time;
     }
 
     void cTimer::update()
     {
-        // TODO: Make this update at 60Hz per second.
-        if (_time > 0)
+        // cScheduler calls this at 60 Hz of emulated time.
+        if (*_time > 0)
         {
-            _time--;
+            (*_time)--;
         }
 
-        if (_time <= 0 && _type == eType::sound)
+        if (*_time <= 0 && _type == eType::sound)
         {
             // TODO: Make it so that sound timer beeps when reaching 0.
         }
@@ -24,11 +28,11 @@ namespace chip8
 
     uint8_t cTimer::get_time() const
     {
-        return _time;
+        return *_time;
     }
 
     void cTimer::set_time(uint8_t time)
     {
-        _time = time;
+        *_time = time;
     }
 }
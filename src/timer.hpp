@@ -5,6 +5,8 @@
 
 namespace chip8
 {
+    struct sMachineState;
+
     class cTimer
     {
       public:
@@ -15,14 +17,16 @@ namespace chip8
             sound,
         };
 
-        explicit cTimer(eType type);
+        // View over the delay or sound time of the given state.
+        cTimer(eType type, sMachineState* state);
+
         void    update();
         uint8_t get_time() const;
         void    set_time(uint8_t time);
 
       private:
-        uint8_t _time {0U};
-        eType   _type {eType::undefined};
+        uint8_t* _time;
+        eType    _type {eType::undefined};
     };
 
 }
@@ -0,0 +1,186 @@
+#include "trace.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <assert.h>
+
+#include <cstring>
+
+namespace chip8
+{
+    namespace
+    {
+        constexpr uint8_t TRACE_MAGIC[4] = {'C', '8', 'T', 'R'};
+
+        bool write_all(int file, const void* data, size_t size)
+        {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+            while (size > 0)
+            {
+                ssize_t written = write(file, bytes, size);
+                if (written <= 0)
+                {
+                    return false;
+                }
+
+                bytes += written;
+                size -= static_cast<size_t>(written);
+            }
+
+            return true;
+        }
+    }
+
+    cTraceRecorder::cTraceRecorder(int32_t block_records)
+      : _block_records(block_records)
+      , _block(new sTraceRecord[block_records])
+    {
+        assert(_block_records > 0);
+    }
+
+    cTraceRecorder::~cTraceRecorder()
+    {
+        close();
+    }
+
+    int32_t cTraceRecorder::open(const std::string& path)
+    {
+        close();
+
+        _file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (_file < 0)
+        {
+            return -1;
+        }
+
+        uint8_t        header[TRACE_HEADER_SIZE] {};
+        const uint16_t version = TRACE_VERSION;
+        const uint16_t record_size = sizeof(sTraceRecord);
+        std::memcpy(header, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+        std::memcpy(header + 4, &version, sizeof(version));
+        std::memcpy(header + 6, &record_size, sizeof(record_size));
+
+        _used = 0;
+        _cycle = 0;
+        _flushed = 0;
+        _failed = !write_all(_file, header, sizeof(header));
+
+        if (_failed)
+        {
+            close();
+            return -1;
+        }
+
+        return 0;
+    }
+
+    int32_t cTraceRecorder::close()
+    {
+        if (_file < 0)
+        {
+            return 0;
+        }
+
+        flush();
+        ::close(_file);
+        _file = -1;
+
+        return _failed ? -1 : 0;
+    }
+
+    void cTraceRecorder::skip_cycles(int64_t cycles)
+    {
+        _cycle += cycles;
+    }
+
+    int64_t cTraceRecorder::get_records() const
+    {
+        return _flushed + _used;
+    }
+
+    int64_t cTraceRecorder::get_cycles() const
+    {
+        return _cycle;
+    }
+
+    void cTraceRecorder::flush()
+    {
+        // Without a file the block is simply reused, so a recorder that is not open drops its records.
+        if (_file >= 0 && !_failed && !write_all(_file, _block.get(), static_cast<size_t>(_used) * sizeof(sTraceRecord)))
+        {
+            _failed = true;
+        }
+
+        _flushed += _used;
+        _used = 0;
+    }
+
+    cTraceFile::~cTraceFile()
+    {
+        if (_mapping != nullptr)
+        {
+            munmap(_mapping, _mapping_size);
+        }
+    }
+
+    int32_t cTraceFile::open(const std::string& path)
+    {
+        int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0)
+        {
+            return -1;
+        }
+
+        struct stat status;
+        if (fstat(file, &status) != 0 || status.st_size < TRACE_HEADER_SIZE)
+        {
+            ::close(file);
+            return -1;
+        }
+
+        void* mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        ::close(file);
+
+        if (mapping == MAP_FAILED)
+        {
+            return -1;
+        }
+
+        const uint8_t* header = static_cast<const uint8_t*>(mapping);
+        uint16_t       version;
+        uint16_t       record_size;
+        std::memcpy(&version, header + 4, sizeof(version));
+        std::memcpy(&record_size, header + 6, sizeof(record_size));
+
+        if (std::memcmp(header, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0 || version != TRACE_VERSION || record_size != sizeof(sTraceRecord))
+        {
+            munmap(mapping, status.st_size);
+            return -1;
+        }
+
+        if (_mapping != nullptr)
+        {
+            munmap(_mapping, _mapping_size);
+        }
+
+        // A trace cut short in the middle of a record loses only that record.
+        _mapping = mapping;
+        _mapping_size = status.st_size;
+        _record_count = (_mapping_size - TRACE_HEADER_SIZE) / static_cast<int64_t>(sizeof(sTraceRecord));
+        return 0;
+    }
+
+    const sTraceRecord* cTraceFile::get_records() const
+    {
+        return reinterpret_cast<const sTraceRecord*>(static_cast<const uint8_t*>(_mapping) + TRACE_HEADER_SIZE);
+    }
+
+    int64_t cTraceFile::get_record_count() const
+    {
+        return _record_count;
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef CHIP8_SRC_TRACEHPP
+#define CHIP8_SRC_TRACEHPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+namespace chip8
+{
+    constexpr uint16_t TRACE_VERSION = 1;
+    constexpr int32_t  TRACE_HEADER_SIZE = 16;
+    constexpr int32_t  DEFAULT_TRACE_BLOCK_RECORDS = 1 << 16; // 1 MB per write.
+    constexpr uint8_t  TRACE_NO_REGISTER = 0xFF;
+
+    // One executed instruction, as it was before it ran. Changes are what it did to V0-VF: the mask has a bit per
+    // register that changed, the index and value are those of the lowest one.
+    struct sTraceRecord
+    {
+        uint32_t cycle; // Cycles since recording started, low 32 bits. Halted cycles count too.
+        uint16_t program_counter;
+        uint16_t opcode;
+        uint16_t register_i;
+        uint16_t changed_registers;
+        uint8_t  register_index; // TRACE_NO_REGISTER if none changed.
+        uint8_t  register_value;
+        uint16_t reserved;
+    };
+
+    static_assert(sizeof(sTraceRecord) == 16, "Trace records are written as they are");
+    static_assert(std::is_trivially_copyable<sTraceRecord>::value, "Trace records are written as they are");
+
+    // Traces are a 16 byte header, "C8TR", u16 version, u16 record size and padding, followed by the records
+    // in host byte order. A host of the other byte order reads the record size as 0x1000 and rejects the file.
+    // Records fill a preallocated block, which is written out whole once full, so recording is a few stores.
+    class cTraceRecorder
+    {
+      public:
+        explicit cTraceRecorder(int32_t block_records = DEFAULT_TRACE_BLOCK_RECORDS);
+        ~cTraceRecorder(); // Closes the file.
+
+        cTraceRecorder(const cTraceRecorder&) = delete;
+        cTraceRecorder& operator=(const cTraceRecorder&) = delete;
+
+        // Creates the file and writes the header. Returns 0 on success and -1 on any error.
+        int32_t open(const std::string& path);
+        // Writes what is left of the block. Returns 0 on success and -1 if any write failed.
+        int32_t close();
+
+        inline void record(uint16_t program_counter, uint16_t opcode, uint16_t register_i, uint16_t changed_registers, uint8_t register_index, uint8_t register_value)
+        {
+            sTraceRecord& record = _block[_used];
+            record.cycle = static_cast<uint32_t>(_cycle);
+            record.program_counter = program_counter;
+            record.opcode = opcode;
+            record.register_i = register_i;
+            record.changed_registers = changed_registers;
+            record.register_index = register_index;
+            record.register_value = register_value;
+            record.reserved = 0U;
+
+            _cycle++;
+            if (++_used == _block_records)
+            {
+                flush();
+            }
+        }
+
+        // Cycles that passed without an instruction, like those halted on FX0A.
+        void skip_cycles(int64_t cycles);
+
+        int64_t get_records() const;
+        int64_t get_cycles() const;
+
+      private:
+        void flush();
+
+        int32_t                         _block_records;
+        std::unique_ptr<sTraceRecord[]> _block;
+        int32_t                         _used {0};
+        int64_t                         _cycle {0};
+        int64_t                         _flushed {0}; // Records already written.
+        int                             _file {-1};
+        bool                            _failed {false};
+    };
+
+    // Read only mapping of a trace file. Record cycles wrap at 2^32, readers add 2^32 whenever one goes backwards.
+    class cTraceFile
+    {
+      public:
+        cTraceFile() = default;
+        ~cTraceFile();
+
+        cTraceFile(const cTraceFile&) = delete;
+        cTraceFile& operator=(const cTraceFile&) = delete;
+
+        // Returns 0 on success and -1 if the file can not be mapped or is not a trace of this version.
+        int32_t open(const std::string& path);
+
+        const sTraceRecord* get_records() const;
+        int64_t             get_record_count() const;
+
+      private:
+        void*   _mapping {nullptr};
+        int64_t _mapping_size {0};
+        int64_t _record_count {0};
+    };
+}
+
+#endif // CHIP8_SRC_TRACEHPP
@@ -0,0 +1,154 @@
+#include "opcode.hpp"
+#include "ram.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// Reads a trace written by 8chip --trace and prints its first instructions, how often each opcode ran and the
+// addresses that ran the most.
+int main(int argc, char* argv[])
+{
+    const char* trace_path {nullptr};
+    int64_t     disassembly_count {32};
+    int32_t     top_count {16};
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strncmp(argv[i], "--trace=", 8) == 0)
+        {
+            trace_path = argv[i] + 8;
+        }
+        else if (std::strncmp(argv[i], "--disasm=", 9) == 0 && std::atoll(argv[i] + 9) >= 0)
+        {
+            disassembly_count = std::atoll(argv[i] + 9);
+        }
+        else if (std::strncmp(argv[i], "--top=", 6) == 0 && std::atoi(argv[i] + 6) >= 0)
+        {
+            top_count = std::atoi(argv[i] + 6);
+        }
+        else
+        {
+            trace_path = nullptr;
+            break;
+        }
+    }
+
+    if (trace_path == nullptr)
+    {
+        std::cout << "Usage: 8chip_trace --trace=PATH [--disasm=N] [--top=N]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    chip8::cTraceFile trace;
+    if (trace.open(trace_path) != 0)
+    {
+        std::cout << "[ERROR] " << trace_path << " is not a trace of version " << chip8::TRACE_VERSION << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const chip8::sTraceRecord* records = trace.get_records();
+    int64_t                    record_count = trace.get_record_count();
+
+    std::vector<uint64_t> opcode_counts(chip8::OPCODE_COUNT, 0U);
+    std::vector<uint64_t> address_counts(chip8::RAM_SIZE, 0U);
+    std::vector<uint16_t> address_opcodes(chip8::RAM_SIZE, 0U); // Last opcode seen at each address.
+
+    char    instruction_text[32];
+    int64_t cycle_base = 0;
+
+    for (int64_t i = 0; i < record_count; i++)
+    {
+        const chip8::sTraceRecord& record = records[i];
+
+        if (i > 0 && record.cycle < records[i - 1].cycle)
+        {
+            cycle_base += INT64_C(1) << 32;
+        }
+
+        opcode_counts[static_cast<size_t>(chip8::classify_opcode(record.opcode))]++;
+
+        if (record.program_counter < chip8::RAM_SIZE)
+        {
+            address_counts[record.program_counter]++;
+            address_opcodes[record.program_counter] = record.opcode;
+        }
+
+        if (i < disassembly_count)
+        {
+            if (i == 0)
+            {
+                std::printf("[INFO] Disassembly\n  %-10s %-5s %-6s %-20s %-5s %s\n", "cycle", "pc", "opcode", "instruction", "I", "changes");
+            }
+
+            chip8::disassemble_instruction(record.opcode, instruction_text, sizeof(instruction_text));
+            std::printf("  %-10" PRId64 " %03X   %04X   %-20s %03X  ", cycle_base + record.cycle, record.program_counter, record.opcode, instruction_text, record.register_i);
+
+            if (record.register_index != chip8::TRACE_NO_REGISTER)
+            {
+                std::printf(" V%X=%02X", record.register_index, record.register_value);
+
+                int32_t others = __builtin_popcount(record.changed_registers) - 1;
+                if (others > 0)
+                {
+                    std::printf(" and %d more", others);
+                }
+            }
+
+            std::printf("\n");
+        }
+    }
+
+    int64_t last_cycle = record_count > 0 ? cycle_base + records[record_count - 1].cycle : 0;
+    std::printf("[INFO] %" PRId64 " instructions, the last one at cycle %" PRId64 "\n", record_count, last_cycle);
+
+    std::vector<chip8::eOpcode> opcodes;
+    for (int32_t i = 0; i < chip8::OPCODE_COUNT; i++)
+    {
+        if (opcode_counts[i] > 0)
+        {
+            opcodes.push_back(static_cast<chip8::eOpcode>(i));
+        }
+    }
+
+    std::sort(opcodes.begin(),
+              opcodes.end(),
+              [&opcode_counts](chip8::eOpcode a, chip8::eOpcode b) { return opcode_counts[static_cast<size_t>(a)] > opcode_counts[static_cast<size_t>(b)]; });
+
+    std::printf("[INFO] Instructions per opcode\n");
+    for (chip8::eOpcode type : opcodes)
+    {
+        uint64_t count = opcode_counts[static_cast<size_t>(type)];
+        std::printf("  %s: %" PRIu64 " (%.2f%%)\n", chip8::get_opcode_name(type), count, 100.0 * count / record_count);
+    }
+
+    std::vector<int32_t> addresses;
+    for (int32_t i = 0; i < chip8::RAM_SIZE; i++)
+    {
+        if (address_counts[i] > 0)
+        {
+            addresses.push_back(i);
+        }
+    }
+
+    // Ties go to the lower address, so the report does not depend on the sort.
+    std::sort(addresses.begin(),
+              addresses.end(),
+              [&address_counts](int32_t a, int32_t b) { return address_counts[a] != address_counts[b] ? address_counts[a] > address_counts[b] : a < b; });
+    addresses.resize(std::min(addresses.size(), static_cast<size_t>(top_count)));
+
+    std::printf("[INFO] Hottest addresses\n");
+    for (int32_t address : addresses)
+    {
+        chip8::disassemble_instruction(address_opcodes[address], instruction_text, sizeof(instruction_text));
+        std::printf("  %03X %-20s %" PRIu64 " (%.2f%%)\n", address, instruction_text, address_counts[address], 100.0 * address_counts[address] / record_count);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+#include "work_pool.hpp"
+
+#include <thread>
+
+namespace chip8
+{
+    cWorkStealingPool::cWorkStealingPool(int32_t thread_count)
+    {
+        if (thread_count <= 0)
+        {
+            thread_count = static_cast<int32_t>(std::thread::hardware_concurrency());
+        }
+
+        // hardware_concurrency may not know.
+        _thread_count = thread_count > 0 ? thread_count : 1;
+
+        for (int32_t i = 0; i < _thread_count; i++)
+        {
+            _queues.push_back(std::make_unique<sWorkQueue>());
+        }
+    }
+
+    void cWorkStealingPool::run(int64_t job_count, const std::function<void(int64_t job_index)>& job)
+    {
+        for (int64_t i = 0; i < job_count; i++)
+        {
+            _queues[i % _thread_count]->jobs.push_back(i);
+        }
+
+        // No job adds more jobs, so a thread that finds every queue empty is done.
+        std::vector<std::thread> threads;
+        for (int32_t worker = 1; worker < _thread_count; worker++)
+        {
+            threads.emplace_back(&cWorkStealingPool::work, this, worker, std::cref(job));
+        }
+
+        work(0, job);
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    int32_t cWorkStealingPool::get_thread_count() const
+    {
+        return _thread_count;
+    }
+
+    int64_t cWorkStealingPool::get_stolen_jobs() const
+    {
+        return _stolen_jobs;
+    }
+
+    bool cWorkStealingPool::pop_own_job(int32_t worker, int64_t* job_index)
+    {
+        sWorkQueue&                 queue = *_queues[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.jobs.empty())
+        {
+            return false;
+        }
+
+        *job_index = queue.jobs.front();
+        queue.jobs.pop_front();
+        return true;
+    }
+
+    bool cWorkStealingPool::steal_job(int32_t worker, int64_t* job_index)
+    {
+        // Start with the next thread along, so thieves spread over the victims.
+        for (int32_t offset = 1; offset < _thread_count; offset++)
+        {
+            sWorkQueue&                 queue = *_queues[(worker + offset) % _thread_count];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            if (!queue.jobs.empty())
+            {
+                *job_index = queue.jobs.back();
+                queue.jobs.pop_back();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void cWorkStealingPool::work(int32_t worker, const std::function<void(int64_t job_index)>& job)
+    {
+        int64_t job_index = 0;
+        int64_t stolen = 0;
+
+        while (true)
+        {
+            if (pop_own_job(worker, &job_index))
+            {
+                job(job_index);
+            }
+            else if (steal_job(worker, &job_index))
+            {
+                stolen++;
+                job(job_index);
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(_stats_mutex);
+        _stolen_jobs += stolen;
+    }
+}
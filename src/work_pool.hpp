@@ -0,0 +1,46 @@
+#ifndef CHIP8_SRC_WORKPOOLHPP
+#define CHIP8_SRC_WORKPOOLHPP
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace chip8
+{
+    // Runs a batch of independent jobs on a fixed set of threads. Jobs are dealt out evenly up front, and a thread
+    // that runs out of its own takes jobs from the far end of another thread's queue, so long jobs do not leave
+    // cores idle.
+    class cWorkStealingPool
+    {
+      public:
+        // Zero or fewer threads uses one per hardware thread.
+        explicit cWorkStealingPool(int32_t thread_count);
+
+        // Calls job(index) for every index in [0, job_count) and returns once all of them finished.
+        void run(int64_t job_count, const std::function<void(int64_t job_index)>& job);
+
+        int32_t get_thread_count() const;
+        int64_t get_stolen_jobs() const; // Jobs run by a thread they were not dealt to, over every run.
+
+      private:
+        struct sWorkQueue
+        {
+            std::mutex          mutex;
+            std::deque<int64_t> jobs;
+        };
+
+        bool pop_own_job(int32_t worker, int64_t* job_index);
+        bool steal_job(int32_t worker, int64_t* job_index);
+        void work(int32_t worker, const std::function<void(int64_t job_index)>& job);
+
+        int32_t                                  _thread_count;
+        std::vector<std::unique_ptr<sWorkQueue>> _queues;
+        std::mutex                               _stats_mutex;
+        int64_t                                  _stolen_jobs {0};
+    };
+}
+
+#endif // CHIP8_SRC_WORKPOOLHPP
@@ -0,0 +1,86 @@
+#include "test_support.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using chip8::cMachine;
+    using chip8::cProcessor;
+    using chip8::test::check;
+
+    // FX55 rewrites an instruction further down the block that is running, after the block was translated.
+    const std::vector<uint8_t> FX55_IN_BLOCK_ROM = {
+        0x60, 0x73, // 200: LD V0, 0x73
+        0x61, 0x05, // 202: LD V1, 5
+        0xA2, 0x0A, // 204: LD I, 0x20A
+        0xF1, 0x55, // 206: LD [I], V1      0x20A becomes ADD V3, 5
+        0x63, 0x00, // 208: LD V3, 0
+        0x73, 0x01, // 20A: ADD V3, 1
+        0x12, 0x0C, // 20C: JP 0x20C
+    };
+
+    // FX33 retargets the jump that ends the running block: the hundreds digit of 200 turns JP 0x210 into JP 0x202.
+    // The tens and ones land on 0x20E, which is never executed.
+    const std::vector<uint8_t> FX33_IN_BLOCK_ROM = {
+        0x12, 0x06, // 200: JP 0x206
+        0x65, 0x01, // 202: LD V5, 1
+        0x12, 0x04, // 204: JP 0x204
+        0x64, 0xC8, // 206: LD V4, 200
+        0xA2, 0x0D, // 208: LD I, 0x20D
+        0xF4, 0x33, // 20A: LD B, V4
+        0x12, 0x10, // 20C: JP 0x210
+        0x00, 0x00, // 20E:
+        0x65, 0x02, // 210: LD V5, 2
+        0x12, 0x12, // 212: JP 0x212
+    };
+
+    // Block 0x202 chains to block 0x208, which another block rewrites once the chain is in place. The chain must not
+    // lead back into the old translation.
+    const std::vector<uint8_t> CHAINED_BLOCK_ROM = {
+        0x63, 0x00, // 200: LD V3, 0
+        0x73, 0x01, // 202: ADD V3, 1
+        0x12, 0x08, // 204: JP 0x208
+        0x00, 0x00, // 206:
+        0x74, 0x01, // 208: ADD V4, 1        rewritten to ADD V4, 0x10
+        0x33, 0x02, // 20A: SE V3, 2
+        0x12, 0x10, // 20C: JP 0x210
+        0x12, 0x18, // 20E: JP 0x218
+        0x33, 0x03, // 210: SE V3, 3
+        0x12, 0x02, // 212: JP 0x202
+        0x12, 0x14, // 214: JP 0x214
+        0x00, 0x00, // 216:
+        0x60, 0x74, // 218: LD V0, 0x74
+        0x61, 0x10, // 21A: LD V1, 0x10
+        0xA2, 0x08, // 21C: LD I, 0x208
+        0xF1, 0x55, // 21E: LD [I], V1
+        0x12, 0x02, // 220: JP 0x202
+    };
+
+    void check_self_modifying_rom(const std::vector<uint8_t>& rom, const char* name, int32_t expected_register, uint8_t expected_value)
+    {
+        cMachine machine;
+        chip8::test::load_rom(&machine, rom, cProcessor::eDispatchMode::block);
+        chip8::test::run_cycles(&machine, 200);
+
+        check(machine.get_processor()->get_register(expected_register) == expected_value, std::string(name) + " ran a stale block");
+
+        // Runs stopping in the middle of blocks have to end in the same state as well.
+        uint64_t reference = chip8::test::run_rom(rom, cProcessor::eDispatchMode::switch_decoder, 200, 200);
+        for (int32_t slice : {1, 3, 7, 200})
+        {
+            check(chip8::test::run_rom(rom, cProcessor::eDispatchMode::block, 200, slice) == reference,
+                  std::string(name) + " in slices of " + std::to_string(slice) + " ends in a different state than switch");
+        }
+    }
+}
+
+int main()
+{
+    check_self_modifying_rom(FX55_IN_BLOCK_ROM, "FX55 within the running block", 3, 5);
+    check_self_modifying_rom(FX33_IN_BLOCK_ROM, "FX33 within the running block", 5, 1);
+    check_self_modifying_rom(CHAINED_BLOCK_ROM, "FX55 over a chained block", 4, 0x12);
+
+    return chip8::test::exit_status();
+}
@@ -0,0 +1,84 @@
+#include "test_support.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+    using chip8::cMachine;
+    using chip8::cProcessor;
+    using chip8::test::check;
+
+    constexpr cProcessor::eDispatchMode MODE = cProcessor::eDispatchMode::decode_cache;
+
+    // FX55 replaces a subroutine body that was already executed, and so decoded, once.
+    const std::vector<uint8_t> FX55_ROM = {
+        0x63, 0x00, // 200: LD V3, 0
+        0x22, 0x10, // 202: CALL 0x210
+        0x60, 0x73, // 204: LD V0, 0x73
+        0x61, 0x10, // 206: LD V1, 0x10
+        0xA2, 0x10, // 208: LD I, 0x210
+        0xF1, 0x55, // 20A: LD [I], V1      0x210 becomes ADD V3, 0x10
+        0x22, 0x10, // 20C: CALL 0x210
+        0x12, 0x0E, // 20E: JP 0x20E
+        0x73, 0x01, // 210: ADD V3, 1
+        0x00, 0xEE, // 212: RET
+    };
+
+    // FX33 rewrites the target of a jump that was already taken once: the hundreds digit of 200 turns JP 0x214 into
+    // JP 0x202, the only way to reach LD V5, 1. The tens and ones land on 0x212, which is never executed.
+    const std::vector<uint8_t> FX33_ROM = {
+        0x12, 0x04, // 200: JP 0x204
+        0x65, 0x01, // 202: LD V5, 1
+        0x64, 0xC8, // 204: LD V4, 200
+        0xA2, 0x11, // 206: LD I, 0x211
+        0x73, 0x01, // 208: ADD V3, 1
+        0x33, 0x03, // 20A: SE V3, 3
+        0x12, 0x10, // 20C: JP 0x210
+        0x12, 0x0E, // 20E: JP 0x20E
+        0x12, 0x14, // 210: JP 0x214
+        0x00, 0x00, // 212:
+        0xF4, 0x33, // 214: LD B, V4
+        0x12, 0x08, // 216: JP 0x208
+    };
+
+    void check_self_modifying_rom(const std::vector<uint8_t>& rom, const char* name, int32_t expected_register, uint8_t expected_value)
+    {
+        cMachine machine;
+        chip8::test::load_rom(&machine, rom, MODE);
+        chip8::test::run_cycles(&machine, 200);
+
+        check(machine.get_processor()->get_register(expected_register) == expected_value, std::string(name) + " ran stale instructions");
+        check(chip8::test::hash_machine(&machine) == chip8::test::run_rom(rom, cProcessor::eDispatchMode::switch_decoder, 200, 200),
+              std::string(name) + " ends in a different state than switch");
+    }
+
+    // Loading a snapshot whose program differs at an address already decoded has to drop what was decoded there.
+    uint64_t run_over_snapshot(cProcessor::eDispatchMode mode)
+    {
+        const std::vector<uint8_t> counting_rom = {0x73, 0x01, 0x12, 0x00}; // ADD V3, 1; JP 0x200
+        const std::vector<uint8_t> loaded_rom = {0x74, 0x10, 0x12, 0x00};   // ADD V4, 0x10; JP 0x200
+
+        cMachine machine;
+        chip8::test::load_rom(&machine, counting_rom, mode);
+        chip8::test::run_cycles(&machine, 10);
+
+        cMachine snapshot_source;
+        chip8::test::load_rom(&snapshot_source, loaded_rom, mode);
+        machine.load_snapshot(snapshot_source.get_state());
+        chip8::test::run_cycles(&machine, 10);
+
+        check(machine.get_processor()->get_register(3) == 0 && machine.get_processor()->get_register(4) == 0x50, "Snapshot load kept instructions decoded before it");
+        return chip8::test::hash_machine(&machine);
+    }
+}
+
+int main()
+{
+    check_self_modifying_rom(FX55_ROM, "FX55 over a subroutine", 3, 0x11);
+    check_self_modifying_rom(FX33_ROM, "FX33 over a jump", 5, 1);
+
+    check(run_over_snapshot(MODE) == run_over_snapshot(cProcessor::eDispatchMode::switch_decoder), "Snapshot load ends in a different state than switch");
+
+    return chip8::test::exit_status();
+}
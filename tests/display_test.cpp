@@ -0,0 +1,70 @@
+#include "display.hpp"
+#include "machine.hpp"
+#include "processor.hpp"
+#include "ram.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+    int32_t failures = 0;
+
+    void check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::cout << "[ERROR] " << what << std::endl;
+            failures++;
+        }
+    }
+
+    // Bit of pixel x in its framebuffer word, pixel 0 being the most significant bit.
+    bool is_pixel_set(const chip8::cDisplay& display, int32_t x, int32_t y)
+    {
+        uint64_t word = display.get_rows()[y * display.get_words_per_row() + x / 64];
+        return (word >> (63 - x % 64)) & 0b1;
+    }
+
+    // DXYF draws 16 rows, the tallest sprite there is. At x = 60 every row straddles the right edge, where
+    // the last word of a row must not spill into the next row, or past the sprite buffer for the last one.
+    void check_sprite_at_right_edge(chip8::cDisplay::eSpriteEdge edge)
+    {
+        const uint8_t rom[] = {
+            0x60, 0x3C, // LD V0, 60
+            0x61, 0x00, // LD V1, 0
+            0xA2, 0x0A, // LD I, 0x20A
+            0xD0, 0x1F, // DRW V0, V1, 16
+            0x12, 0x08, // JP 0x208
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        };
+
+        chip8::cMachine machine;
+        machine.get_ram()->load_rom(rom, sizeof(rom));
+        machine.get_display()->set_sprite_edge(edge);
+        machine.get_processor()->run_cycles(4, machine.get_ram(), machine.get_display(), machine.get_keyboard(), machine.get_delay_timer(), machine.get_sound_timer());
+
+        const chip8::cDisplay& display = *machine.get_display();
+        bool                   wrap = edge == chip8::cDisplay::eSpriteEdge::wrap;
+
+        for (int32_t y = 0; y < display.get_height(); y++)
+        {
+            for (int32_t x = 0; x < display.get_width(); x++)
+            {
+                bool expected = y < chip8::MAX_SPRITE_HEIGHT && (x >= 60 || (wrap && x < 4));
+                check(is_pixel_set(display, x, y) == expected, wrap ? "DXYF at x = 60 wrapping draws the wrong pixels" : "DXYF at x = 60 clipping draws the wrong pixels");
+            }
+        }
+
+        check(machine.get_processor()->get_register(0xF) == 0, "DXYF on a clear screen reports a collision");
+    }
+}
+
+int main()
+{
+    check_sprite_at_right_edge(chip8::cDisplay::eSpriteEdge::clip);
+    check_sprite_at_right_edge(chip8::cDisplay::eSpriteEdge::wrap);
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,163 @@
+#include "test_support.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using chip8::cProcessor;
+    using chip8::test::check;
+
+    constexpr int32_t RANDOM_PROGRAMS = 300;
+    constexpr int32_t PROGRAM_INSTRUCTIONS = 32;
+    constexpr int32_t PROGRAM_CYCLES = 2000;
+
+    // Ends every program: a jump onto itself, preceded by one more so that a skip on the last instruction lands on a jump too.
+    void append_halt(std::vector<uint8_t>* rom)
+    {
+        uint16_t address = static_cast<uint16_t>(chip8::PROGRAM_START_LOCATION + rom->size() + 2);
+        rom->insert(rom->end(), {static_cast<uint8_t>(0x10 | address >> 8), static_cast<uint8_t>(address & 0xFF)});
+        rom->insert(rom->end(), {static_cast<uint8_t>(0x10 | address >> 8), static_cast<uint8_t>(address & 0xFF)});
+    }
+
+    void append_opcode(std::vector<uint8_t>* rom, uint16_t opcode)
+    {
+        rom->insert(rom->end(), {static_cast<uint8_t>(opcode >> 8), static_cast<uint8_t>(opcode & 0xFF)});
+    }
+
+    // ALU, skip and jump instructions only, so every program runs until the cycle limit. VF is picked as X or Y far more
+    // often than chance, and I is loaded close to the end of ram, where FX1E wraps.
+    std::vector<uint8_t> generate_program(std::mt19937* random)
+    {
+        constexpr uint16_t ALU_OPERATIONS[] = {0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0xE};
+
+        auto pick = [random](uint32_t count) { return static_cast<uint16_t>((*random)() % count); };
+        auto pick_register = [&pick]() { return pick(4) == 0 ? uint16_t {0xF} : pick(16); };
+
+        std::vector<uint8_t> rom;
+
+        for (int32_t i = 0; i < PROGRAM_INSTRUCTIONS; i++)
+        {
+            uint16_t x = pick_register();
+            uint16_t y = pick_register();
+            uint16_t nn = pick(256);
+
+            switch (pick(10))
+            {
+                case 0:
+                    append_opcode(&rom, 0x6000 | x << 8 | nn);
+                    break;
+                case 1:
+                    append_opcode(&rom, 0x7000 | x << 8 | nn);
+                    break;
+                case 2:
+                case 3:
+                case 4:
+                    append_opcode(&rom, 0x8000 | x << 8 | y << 4 | ALU_OPERATIONS[pick(9)]);
+                    break;
+                case 5:
+                    append_opcode(&rom, 0xA000 | (pick(2) == 0 ? 0xF00 | nn : pick(0x1000)));
+                    break;
+                case 6:
+                    append_opcode(&rom, 0xF01E | x << 8);
+                    break;
+                case 7:
+                {
+                    constexpr uint16_t SKIPS[] = {0x3000, 0x4000, 0x5000, 0x9000};
+                    uint16_t           skip = SKIPS[pick(4)];
+                    append_opcode(&rom, skip == 0x3000 || skip == 0x4000 ? skip | x << 8 | nn : skip | x << 8 | y << 4);
+                }
+                break;
+                case 8:
+                {
+                    uint16_t target = static_cast<uint16_t>(chip8::PROGRAM_START_LOCATION + 2 * pick(PROGRAM_INSTRUCTIONS + 1));
+                    append_opcode(&rom, 0x1000 | target);
+                }
+                break;
+                default:
+                    append_opcode(&rom, 0x8000 | 0xF << 8 | y << 4 | ALU_OPERATIONS[4 + pick(5)]);
+                    break;
+            }
+        }
+
+        append_halt(&rom);
+        return rom;
+    }
+
+    void check_against_switch(const std::vector<uint8_t>& rom, int32_t cycles, const std::string& what)
+    {
+        uint64_t reference = chip8::test::run_rom(rom, cProcessor::eDispatchMode::switch_decoder, cycles, cycles);
+
+        // Slices of 5 end in the middle of compiled runs, which are then finished by the interpreter.
+        check(chip8::test::run_rom(rom, cProcessor::eDispatchMode::jit, cycles, cycles) == reference, what + " differs from switch");
+        check(chip8::test::run_rom(rom, cProcessor::eDispatchMode::jit, cycles, 5) == reference, what + " in slices of 5 differs from switch");
+    }
+
+    // 8XY4 to 8XYE with X = F write VF twice. The flag has to win over the result, like in the interpreter.
+    void check_flag_order()
+    {
+        constexpr uint8_t VALUES[] = {0x00, 0x01, 0x7F, 0x80, 0xFF};
+
+        for (uint16_t operation : {0x4, 0x5, 0x6, 0x7, 0xE})
+        {
+            for (uint16_t y : {0x0, 0xF})
+            {
+                for (uint8_t flag : VALUES)
+                {
+                    for (uint8_t value : VALUES)
+                    {
+                        std::vector<uint8_t> rom;
+                        append_opcode(&rom, 0x6F00 | flag);
+                        append_opcode(&rom, 0x6000 | value);
+                        append_opcode(&rom, 0x8F00 | y << 4 | operation);
+                        append_halt(&rom);
+
+                        char name[64];
+                        std::snprintf(name, sizeof(name), "8F%X%X with VF=%02X V0=%02X", y, operation, flag, value);
+                        check_against_switch(rom, 8, name);
+                    }
+                }
+            }
+        }
+    }
+
+    // FX1E past the end of ram wraps I around.
+    void check_i_wrap()
+    {
+        for (uint16_t address : {0xF00, 0xFF0, 0xFFE, 0xFFF})
+        {
+            for (uint8_t value : {0x01, 0x0F, 0x10, 0xFF})
+            {
+                for (uint16_t x : {0x0, 0xF})
+                {
+                    std::vector<uint8_t> rom;
+                    append_opcode(&rom, 0xA000 | address);
+                    append_opcode(&rom, 0x6000 | x << 8 | value);
+                    append_opcode(&rom, 0xF01E | x << 8);
+                    append_halt(&rom);
+
+                    char name[64];
+                    std::snprintf(name, sizeof(name), "F%X1E with I=%03X V%X=%02X", x, address, x, value);
+                    check_against_switch(rom, 8, name);
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    check_flag_order();
+    check_i_wrap();
+
+    std::mt19937 random {8};
+    for (int32_t i = 0; i < RANDOM_PROGRAMS; i++)
+    {
+        check_against_switch(generate_program(&random), PROGRAM_CYCLES, "Random program " + std::to_string(i));
+    }
+
+    return chip8::test::exit_status();
+}
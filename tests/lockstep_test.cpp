@@ -0,0 +1,184 @@
+#include "test_support.hpp"
+
+#include "lockstep.hpp"
+#include "scheduler.hpp"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using chip8::test::check;
+
+    constexpr int32_t  RANDOM_PROGRAMS = 60;
+    constexpr int32_t  PROGRAM_INSTRUCTIONS = 48;
+    constexpr int32_t  SUBROUTINE_INSTRUCTIONS = 4;
+    constexpr int32_t  PROGRAM_CYCLES = 3000;
+    constexpr int32_t  INSTANCE_COUNT = 40; // More than one lane block, and not a multiple of it.
+    constexpr uint64_t BASE_SEED = 1234U;
+
+    void append_opcode(std::vector<uint8_t>* rom, uint16_t opcode)
+    {
+        rom->insert(rom->end(), {static_cast<uint8_t>(opcode >> 8), static_cast<uint8_t>(opcode & 0xFF)});
+    }
+
+    // Instructions that always fall through to the next one. CXNN makes the instances diverge on their seeds, so groups
+    // are split, peeled off and formed again. I stays above the program, where FX33 and FX55 can not turn it into
+    // invalid opcodes, which is also why FX1E is left out.
+    uint16_t generate_straight_opcode(std::mt19937* random)
+    {
+        constexpr uint16_t ALU_OPERATIONS[] = {0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0xE};
+        constexpr uint16_t F_OPERATIONS[] = {0x07, 0x15, 0x18, 0x29, 0x33, 0x55, 0x65};
+
+        auto     pick = [random](uint32_t count) { return static_cast<uint16_t>((*random)() % count); };
+        uint16_t x = pick(16);
+        uint16_t y = pick(16);
+
+        switch (pick(10))
+        {
+            case 0:
+                return 0x6000 | x << 8 | pick(256);
+            case 1:
+                return 0x7000 | x << 8 | pick(256);
+            case 2:
+            case 3:
+                return 0x8000 | x << 8 | y << 4 | ALU_OPERATIONS[pick(9)];
+            case 4:
+                return 0xC000 | x << 8 | pick(256);
+            case 5:
+                return 0xA300 + pick(0xC00);
+            case 6:
+                return 0xD000 | x << 8 | y << 4 | pick(16);
+            case 7:
+                return 0x0E00;
+            default:
+                return 0xF000 | x << 8 | F_OPERATIONS[pick(7)];
+        }
+    }
+
+    // Every instruction but FX0A, which would halt without input, and BNNN, which could jump anywhere. Jumps stay in
+    // the body and calls go to one subroutine after it, so the stack never overflows.
+    std::vector<uint8_t> generate_program(std::mt19937* random)
+    {
+        constexpr uint16_t SUBROUTINE = chip8::PROGRAM_START_LOCATION + 2 * (PROGRAM_INSTRUCTIONS + 2);
+
+        auto pick = [random](uint32_t count) { return static_cast<uint16_t>((*random)() % count); };
+
+        std::vector<uint8_t> rom;
+
+        for (int32_t i = 0; i < PROGRAM_INSTRUCTIONS; i++)
+        {
+            uint16_t x = pick(16);
+            uint16_t y = pick(16);
+            uint16_t nn = pick(256);
+
+            switch (pick(12))
+            {
+                case 0:
+                {
+                    constexpr uint16_t SKIPS[] = {0x3000, 0x4000, 0x5000, 0x9000};
+                    uint16_t           skip = SKIPS[pick(4)];
+                    append_opcode(&rom, skip == 0x3000 || skip == 0x4000 ? skip | x << 8 | nn : skip | x << 8 | y << 4);
+                }
+                break;
+                case 1:
+                    append_opcode(&rom, pick(2) == 0 ? 0xE09E | x << 8 : 0xE0A1 | x << 8);
+                    break;
+                case 2:
+                    append_opcode(&rom, 0x1000 | (chip8::PROGRAM_START_LOCATION + 2 * pick(PROGRAM_INSTRUCTIONS)));
+                    break;
+                case 3:
+                    append_opcode(&rom, 0x2000 | SUBROUTINE);
+                    break;
+                default:
+                    append_opcode(&rom, generate_straight_opcode(random));
+                    break;
+            }
+        }
+
+        // A skip on the last instruction lands on the second jump.
+        append_opcode(&rom, 0x1000 | chip8::PROGRAM_START_LOCATION);
+        append_opcode(&rom, 0x1000 | chip8::PROGRAM_START_LOCATION);
+
+        for (int32_t i = 0; i < SUBROUTINE_INSTRUCTIONS; i++)
+        {
+            append_opcode(&rom, generate_straight_opcode(random));
+        }
+
+        append_opcode(&rom, 0x00EE);
+        return rom;
+    }
+
+    // Same run as 8chip_lockstep's reference: one machine per instance, no idle loop skipping.
+    uint64_t run_processor(const std::vector<uint8_t>& rom, uint64_t seed)
+    {
+        chip8::cMachine machine;
+        if (!chip8::test::load_rom(&machine, rom, chip8::cProcessor::eDispatchMode::switch_decoder))
+        {
+            return 0U;
+        }
+
+        machine.get_processor()->set_random_seed(seed);
+
+        chip8::cScheduler scheduler {chip8::DEFAULT_INSTRUCTIONS_PER_SECOND, chip8::cScheduler::ePacing::unthrottled};
+        scheduler.set_idle_skipping(false);
+        scheduler.run(PROGRAM_CYCLES,
+                      INT64_MAX,
+                      machine.get_processor(),
+                      machine.get_ram(),
+                      machine.get_display(),
+                      machine.get_keyboard(),
+                      machine.get_delay_timer(),
+                      machine.get_sound_timer());
+
+        return chip8::test::hash_machine(&machine);
+    }
+
+    void check_against_processor(const std::vector<uint8_t>& rom, const std::vector<uint64_t>& references, bool vector_kernels, const std::string& what)
+    {
+        chip8::cLockstepBatch batch {INSTANCE_COUNT, chip8::DEFAULT_INSTRUCTIONS_PER_SECOND};
+        check(batch.load_rom(rom.data(), static_cast<int32_t>(rom.size())) == 0, what + " does not load");
+
+        if (!batch.set_vector_kernels(vector_kernels))
+        {
+            std::cout << "[WARNING] Host has no AVX2, skipping the lockstep groups" << std::endl;
+            return;
+        }
+
+        for (int32_t i = 0; i < INSTANCE_COUNT; i++)
+        {
+            batch.set_random_seed(i, BASE_SEED + i);
+        }
+
+        batch.run(PROGRAM_CYCLES);
+
+        for (int32_t i = 0; i < INSTANCE_COUNT; i++)
+        {
+            std::string instance = what + " instance " + std::to_string(i) + (vector_kernels ? " in groups" : " one by one");
+            check(batch.hash_instance(i) == references[i], instance + " differs from cProcessor");
+        }
+    }
+}
+
+int main()
+{
+    std::mt19937 random {18};
+    for (int32_t program = 0; program < RANDOM_PROGRAMS; program++)
+    {
+        std::vector<uint8_t> rom = generate_program(&random);
+
+        std::vector<uint64_t> references(INSTANCE_COUNT);
+        for (int32_t i = 0; i < INSTANCE_COUNT; i++)
+        {
+            references[i] = run_processor(rom, BASE_SEED + i);
+        }
+
+        std::string what = "Random program " + std::to_string(program);
+        check_against_processor(rom, references, false, what);
+        check_against_processor(rom, references, true, what);
+    }
+
+    return chip8::test::exit_status();
+}
@@ -0,0 +1,172 @@
+#include "test_support.hpp"
+
+#include "rewind.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using chip8::sMachineState;
+    using chip8::test::check;
+
+    bool is_same_state(const sMachineState& a, const sMachineState& b)
+    {
+        return std::memcmp(&a, &b, sizeof(sMachineState)) == 0;
+    }
+
+    // One state per frame, each changing a few registers and ram bytes like a running ROM. With rewrite_ram, every 37th
+    // frame rewrites the whole ram, so the deltas after it are almost as big as the state.
+    std::vector<sMachineState> generate_frames(int32_t count, uint32_t seed, bool rewrite_ram)
+    {
+        std::mt19937               random {seed};
+        std::vector<sMachineState> frames;
+        sMachineState              state;
+
+        for (int32_t frame = 0; frame < count; frame++)
+        {
+            state.program_counter = static_cast<uint16_t>(chip8::PROGRAM_START_LOCATION + 2 * (random() % 64));
+            state.delay_time -= state.delay_time > 0 ? 1 : 0;
+            state.registers[random() % chip8::REGISTER_COUNT] = static_cast<uint8_t>(random());
+            state.random_state = state.random_state * 6364136223846793005ULL + 1442695040888963407ULL;
+
+            int32_t changed_bytes = rewrite_ram && frame % 37 == 36 ? chip8::RAM_SIZE : static_cast<int32_t>(random() % 24);
+            for (int32_t i = 0; i < changed_bytes; i++)
+            {
+                state.ram[changed_bytes == chip8::RAM_SIZE ? i : random() % chip8::RAM_SIZE] = static_cast<uint8_t>(random());
+            }
+
+            state.rows[random() % (chip8::DISPLAY_HEIGHT * chip8::DISPLAY_WORDS_PER_ROW)] ^= 1ULL << (random() % 64);
+            frames.push_back(state);
+        }
+
+        return frames;
+    }
+
+    // Steps back until the buffer runs out, checking each state against the frame pushed at that point.
+    // frames[newest] is the last one pushed. Returns the number of frames stepped back over.
+    int32_t check_step_back(chip8::cRewindBuffer* rewind, const std::vector<sMachineState>& frames, int32_t newest, const std::string& what)
+    {
+        int32_t       steps = 0;
+        sMachineState restored;
+
+        while (rewind->step_back(&restored))
+        {
+            steps++;
+            if (newest - steps < 0 || !is_same_state(restored, frames[newest - steps]))
+            {
+                check(false, what + ": frame " + std::to_string(newest - steps) + " was not restored");
+                return steps;
+            }
+        }
+
+        check(rewind->get_frame_count() == 1, what + ": step back stopped before the oldest frame");
+        return steps;
+    }
+
+    // Fewer frames than the capacity, nothing is dropped.
+    void check_partial_history()
+    {
+        std::vector<sMachineState> frames = generate_frames(50, 1U, false);
+        chip8::cRewindBuffer       rewind {100, 10};
+
+        for (const sMachineState& frame : frames)
+        {
+            rewind.push(frame);
+        }
+
+        check(rewind.get_frame_count() == 50, "Partial history lost frames");
+        check(check_step_back(&rewind, frames, 49, "Partial history") == 49, "Partial history did not step back to the first frame");
+    }
+
+    // Many times the capacity: the frame ring and the arena both wrap around over and over. Every 50 frames a copy of
+    // the buffer is stepped all the way back, so a record overwritten while still held shows up.
+    // Within the arena budget only whole groups are dropped, and only to make room for new frames.
+    void check_wrap_around()
+    {
+        constexpr int32_t FRAME_CAPACITY = 40;
+        constexpr int32_t KEYFRAME_INTERVAL = 8;
+
+        std::vector<sMachineState> frames = generate_frames(1000, 2U, false);
+        chip8::cRewindBuffer       rewind {FRAME_CAPACITY, KEYFRAME_INTERVAL};
+
+        for (int32_t i = 0; i < static_cast<int32_t>(frames.size()); i++)
+        {
+            rewind.push(frames[i]);
+
+            check(rewind.get_frame_count() <= FRAME_CAPACITY, "Wrap around holds more frames than its capacity");
+            if (i >= FRAME_CAPACITY)
+            {
+                check(rewind.get_frame_count() > FRAME_CAPACITY - KEYFRAME_INTERVAL, "Wrap around dropped more than a group");
+            }
+
+            if (i % 50 == 49)
+            {
+                chip8::cRewindBuffer copy = rewind;
+                int32_t              held = copy.get_frame_count();
+                check(check_step_back(&copy, frames, i, "Wrap around at frame " + std::to_string(i)) == held - 1, "Wrap around lost held frames");
+            }
+        }
+    }
+
+    // Deltas far over the budget: groups are also dropped for arena space, and what is left still restores exactly.
+    void check_over_budget()
+    {
+        std::vector<sMachineState> frames = generate_frames(1000, 5U, true);
+        chip8::cRewindBuffer       rewind {40, 8, 48};
+
+        for (int32_t i = 0; i < static_cast<int32_t>(frames.size()); i++)
+        {
+            rewind.push(frames[i]);
+            check(rewind.get_used_bytes() <= rewind.get_arena_bytes(), "Over budget uses more than its arena");
+
+            if (i % 50 == 49)
+            {
+                chip8::cRewindBuffer copy = rewind;
+                check_step_back(&copy, frames, i, "Over budget at frame " + std::to_string(i));
+            }
+        }
+    }
+
+    // Stepping back and pushing again, like holding and releasing the rewind key: new frames replace the ones stepped
+    // back over, and the ones before are still restored exactly.
+    void check_interleaved()
+    {
+        std::vector<sMachineState> timeline = generate_frames(600, 3U, true);
+        std::vector<sMachineState> replay = generate_frames(600, 4U, true);
+        std::vector<sMachineState> pushed;
+        chip8::cRewindBuffer       rewind {120, 15, 64};
+        sMachineState              restored;
+
+        for (int32_t round = 0; round < 10; round++)
+        {
+            const std::vector<sMachineState>& source = round % 2 == 0 ? timeline : replay;
+            for (int32_t i = 0; i < 60; i++)
+            {
+                pushed.push_back(source[round * 60 + i]);
+                rewind.push(pushed.back());
+            }
+
+            for (int32_t i = 0; i < 25 && rewind.step_back(&restored); i++)
+            {
+                pushed.pop_back();
+                check(is_same_state(restored, pushed.back()), "Interleaved round " + std::to_string(round) + " restored the wrong frame");
+            }
+        }
+
+        check_step_back(&rewind, pushed, static_cast<int32_t>(pushed.size()) - 1, "Interleaved");
+    }
+}
+
+int main()
+{
+    check_partial_history();
+    check_wrap_around();
+    check_over_budget();
+    check_interleaved();
+
+    return chip8::test::exit_status();
+}
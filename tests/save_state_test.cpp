@@ -0,0 +1,147 @@
+#include "test_support.hpp"
+
+#include "save_state.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace
+{
+    using chip8::cMachine;
+    using chip8::cProcessor;
+    using chip8::test::check;
+
+    constexpr cProcessor::eDispatchMode MODE = cProcessor::eDispatchMode::switch_decoder;
+
+    // Leaves a call on the stack, timers running, random numbers drawn and sprites on screen, so every part of the
+    // state has something to carry.
+    const std::vector<uint8_t> ROM = {
+        0x6A, 0x30, // 200: LD VA, 0x30
+        0xFA, 0x15, // 202: LD DT, VA
+        0xFA, 0x18, // 204: LD ST, VA
+        0x22, 0x08, // 206: CALL 0x208
+        0xCB, 0x0F, // 208: RND VB, 0x0F
+        0xFB, 0x29, // 20A: LD F, VB
+        0xDA, 0xB5, // 20C: DRW VA, VB, 5
+        0x7A, 0x03, // 20E: ADD VA, 3
+        0x12, 0x08, // 210: JP 0x208
+    };
+
+    constexpr int32_t CYCLES_BEFORE_SAVE = 1001;
+    constexpr int32_t CYCLES_AFTER_LOAD = 500;
+
+    // What the state hash leaves out.
+    bool is_same_hidden_state(const chip8::sMachineState& a, const chip8::sMachineState& b)
+    {
+        bool same_stack = a.stack_pointer == b.stack_pointer;
+        for (int32_t i = 0; same_stack && i < a.stack_pointer; i++)
+        {
+            same_stack = a.stack[i] == b.stack[i];
+        }
+
+        return same_stack && a.random_seed == b.random_seed && a.random_state == b.random_state && a.key_state == b.key_state &&
+               a.pending_press == b.pending_press && a.waiting_for_key == b.waiting_for_key && a.key_register == b.key_register;
+    }
+
+    // Runs the rom on a fresh machine and returns its save state.
+    std::vector<uint8_t> save_running_machine(cMachine* machine)
+    {
+        chip8::test::load_rom(machine, ROM, MODE);
+        machine->get_processor()->set_random_seed(21U);
+        machine->get_keyboard()->press_key(0x7);
+        chip8::test::run_cycles(machine, CYCLES_BEFORE_SAVE);
+
+        std::vector<uint8_t> buffer(chip8::MAX_SAVE_STATE_SIZE);
+        int32_t              size = machine->save_state(buffer.data(), static_cast<int32_t>(buffer.size()));
+        check(size > chip8::SAVE_STATE_HEADER_SIZE, "Save state failed");
+        buffer.resize(size > 0 ? size : 0);
+        return buffer;
+    }
+
+    void check_round_trip()
+    {
+        cMachine             saved;
+        std::vector<uint8_t> buffer = save_running_machine(&saved);
+        check(saved.get_state().stack_pointer == 1, "The rom did not leave its call on the stack");
+
+        cMachine loaded;
+        check(loaded.load_state(buffer.data(), static_cast<int32_t>(buffer.size())) == static_cast<int32_t>(buffer.size()), "Load state failed");
+        check(chip8::test::hash_machine(&loaded) == chip8::test::hash_machine(&saved), "Loaded state hashes differently than the saved one");
+        check(is_same_hidden_state(loaded.get_state(), saved.get_state()), "Loaded stack, generator or keyboard differ from the saved ones");
+
+        // Both go on the same way, random numbers and returns included.
+        chip8::test::run_cycles(&saved, CYCLES_AFTER_LOAD);
+        chip8::test::run_cycles(&loaded, CYCLES_AFTER_LOAD);
+        check(chip8::test::hash_machine(&loaded) == chip8::test::hash_machine(&saved), "Loaded machine runs differently than the saved one");
+
+        std::vector<uint8_t> too_small(buffer.size() - 1);
+        check(saved.save_state(too_small.data(), static_cast<int32_t>(too_small.size())) == -1, "Save state overran a short buffer");
+    }
+
+    void check_file_round_trip()
+    {
+        cMachine saved;
+        save_running_machine(&saved);
+
+        std::string path = "save_state_test_" + std::to_string(getpid()) + ".c8s";
+        check(saved.save_state_file(path) == 0, "Save state file failed");
+
+        cMachine loaded;
+        check(loaded.load_state_file(path) == 0, "Load state file failed");
+        check(chip8::test::hash_machine(&loaded) == chip8::test::hash_machine(&saved), "Loaded state file hashes differently than the saved one");
+        check(is_same_hidden_state(loaded.get_state(), saved.get_state()), "Loaded state file has a different stack, generator or keyboard");
+
+        std::remove(path.c_str());
+    }
+
+    // A rejected state leaves the machine exactly as it was.
+    void check_rejected(const std::vector<uint8_t>& buffer, const std::string& what)
+    {
+        cMachine machine;
+        chip8::test::load_rom(&machine, ROM, MODE);
+        chip8::test::run_cycles(&machine, 100);
+        uint64_t before = chip8::test::hash_machine(&machine);
+
+        check(machine.load_state(buffer.data(), static_cast<int32_t>(buffer.size())) == -1, what + " was loaded");
+        check(chip8::test::hash_machine(&machine) == before, what + " changed the machine");
+    }
+
+    void check_rejections()
+    {
+        cMachine             saved;
+        std::vector<uint8_t> buffer = save_running_machine(&saved);
+
+        std::vector<uint8_t> bad_magic = buffer;
+        bad_magic[0] = 'X';
+        check_rejected(bad_magic, "Bad magic");
+
+        // The version sits in the header, outside of the checksum.
+        std::vector<uint8_t> bad_version = buffer;
+        bad_version[4] = static_cast<uint8_t>(chip8::SAVE_STATE_VERSION + 1);
+        check_rejected(bad_version, "Bad version");
+
+        std::vector<uint8_t> bad_body = buffer;
+        bad_body[bad_body.size() - 1] ^= 0x01;
+        check_rejected(bad_body, "Body not matching its checksum");
+
+        std::vector<uint8_t> bad_checksum = buffer;
+        bad_checksum[12] ^= 0x01;
+        check_rejected(bad_checksum, "Bad checksum");
+
+        std::vector<uint8_t> truncated(buffer.begin(), buffer.end() - 1);
+        check_rejected(truncated, "Truncated state");
+    }
+}
+
+int main()
+{
+    check_round_trip();
+    check_file_round_trip();
+    check_rejections();
+
+    return chip8::test::exit_status();
+}
@@ -0,0 +1,97 @@
+#ifndef CHIP8_TESTS_TESTSUPPORTHPP
+#define CHIP8_TESTS_TESTSUPPORTHPP
+
+#include "headless.hpp"
+#include "machine.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Helpers shared by the tests comparing dispatch modes. Every test is its own executable, so these are header only.
+namespace chip8
+{
+    namespace test
+    {
+        inline int32_t failures = 0;
+
+        inline void check(bool condition, const std::string& what)
+        {
+            if (!condition)
+            {
+                std::cout << "[ERROR] " << what << std::endl;
+                failures++;
+            }
+        }
+
+        inline int exit_status()
+        {
+            return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        inline const char* get_mode_name(cProcessor::eDispatchMode mode)
+        {
+            switch (mode)
+            {
+                case cProcessor::eDispatchMode::switch_decoder:
+                    return "switch";
+                case cProcessor::eDispatchMode::table:
+                    return "table";
+                case cProcessor::eDispatchMode::decode_cache:
+                    return "cache";
+                case cProcessor::eDispatchMode::block:
+                    return "block";
+                case cProcessor::eDispatchMode::jit:
+                    return "jit";
+                case cProcessor::eDispatchMode::threaded:
+                    return "threaded";
+            }
+
+            return "unknown";
+        }
+
+        // Loads the rom and selects the dispatch mode. Returns false if the rom does not fit.
+        inline bool load_rom(cMachine* machine, const std::vector<uint8_t>& rom, cProcessor::eDispatchMode mode)
+        {
+            machine->get_processor()->set_dispatch_mode(mode);
+            return machine->get_ram()->load_rom(rom.data(), static_cast<int32_t>(rom.size())) == 0;
+        }
+
+        inline int32_t run_cycles(cMachine* machine, int32_t cycles)
+        {
+            return machine->get_processor()->run_cycles(cycles,
+                                                        machine->get_ram(),
+                                                        machine->get_display(),
+                                                        machine->get_keyboard(),
+                                                        machine->get_delay_timer(),
+                                                        machine->get_sound_timer());
+        }
+
+        inline uint64_t hash_machine(cMachine* machine)
+        {
+            return hash_machine_state(machine->get_processor(), machine->get_ram(), machine->get_display(), machine->get_delay_timer(), machine->get_sound_timer());
+        }
+
+        // Runs the rom for the given cycles, in run_cycles calls of at most slice cycles, and returns the state hash.
+        inline uint64_t run_rom(const std::vector<uint8_t>& rom, cProcessor::eDispatchMode mode, int32_t cycles, int32_t slice)
+        {
+            cMachine machine;
+            if (!load_rom(&machine, rom, mode))
+            {
+                return 0U;
+            }
+
+            for (int32_t executed = 0; executed < cycles; executed += slice)
+            {
+                run_cycles(&machine, std::min(slice, cycles - executed));
+            }
+
+            return hash_machine(&machine);
+        }
+    }
+}
+
+#endif // CHIP8_TESTS_TESTSUPPORTHPP
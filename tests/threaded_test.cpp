@@ -0,0 +1,94 @@
+#include "test_support.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using chip8::cMachine;
+    using chip8::cProcessor;
+    using chip8::test::check;
+
+    // Every fused pair at least once, then two FX0A halts.
+    const std::vector<uint8_t> FUSED_PAIR_ROM = {
+        0x60, 0x05, // 200: LD V0, 5
+        0x61, 0x03, // 202: LD V1, 3          6XNN 6XNN
+        0x62, 0x07, // 204: LD V2, 7
+        0xA2, 0x30, // 206: LD I, 0x230       6XNN ANNN
+        0xA2, 0x30, // 208: LD I, 0x230
+        0xD0, 0x15, // 20A: DRW V0, V1, 5     ANNN DXYN
+        0x73, 0x01, // 20C: ADD V3, 1
+        0x33, 0x05, // 20E: SE V3, 5          7XNN 3XNN
+        0x12, 0x0C, // 210: JP 0x20C
+        0xA2, 0x36, // 212: LD I, 0x236
+        0xF2, 0x65, // 214: LD V2, [I]        ANNN FX65
+        0xF4, 0x0A, // 216: LD V4, K
+        0x75, 0x01, // 218: ADD V5, 1
+        0xF6, 0x0A, // 21A: LD V6, K
+        0x12, 0x1C, // 21C: JP 0x21C
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 21E:
+        0xF0, 0x90, 0x90, 0x90, 0xF0, 0x00, // 230: sprite
+        0x11, 0x22, 0x33,                   // 236: table
+    };
+
+    constexpr uint8_t PRESSED_KEYS[] = {0xA, 0x3};
+    constexpr int32_t RUNS_PER_KEY = 60;
+
+    struct sSession
+    {
+        std::vector<int32_t> executed; // What each run_cycles call returned.
+        std::vector<bool>    waiting;  // Whether the processor was halted on FX0A before each key press.
+        uint64_t             state_hash;
+        cMachine             machine;
+    };
+
+    // Runs in slices until the processor halts, presses a key, and so on for each key.
+    void run_session(cProcessor::eDispatchMode mode, int32_t slice, sSession* session)
+    {
+        chip8::test::load_rom(&session->machine, FUSED_PAIR_ROM, mode);
+
+        for (uint8_t key : PRESSED_KEYS)
+        {
+            for (int32_t i = 0; i < RUNS_PER_KEY; i++)
+            {
+                session->executed.push_back(chip8::test::run_cycles(&session->machine, slice));
+            }
+
+            session->waiting.push_back(session->machine.get_processor()->is_waiting_for_key());
+            session->machine.get_keyboard()->press_key(key);
+            session->machine.get_keyboard()->release_key(key);
+        }
+
+        for (int32_t i = 0; i < RUNS_PER_KEY; i++)
+        {
+            session->executed.push_back(chip8::test::run_cycles(&session->machine, slice));
+        }
+
+        session->state_hash = chip8::test::hash_machine(&session->machine);
+    }
+}
+
+int main()
+{
+    // Slices of 1 and 3 end between the two halves of fused pairs.
+    for (int32_t slice : {1, 2, 3, 7, 100})
+    {
+        sSession reference;
+        sSession threaded;
+        run_session(cProcessor::eDispatchMode::switch_decoder, slice, &reference);
+        run_session(cProcessor::eDispatchMode::threaded, slice, &threaded);
+
+        std::string      what = "Threaded in slices of " + std::to_string(slice);
+        const cProcessor& processor = *threaded.machine.get_processor();
+
+        check(threaded.waiting == std::vector<bool> {true, true}, what + " did not halt on FX0A");
+        check(threaded.executed == reference.executed, what + " reports other cycle counts than switch");
+        check(threaded.state_hash == reference.state_hash, what + " ends in a different state than switch");
+        check(processor.get_register(0) == 0x11 && processor.get_register(1) == 0x22 && processor.get_register(2) == 0x33, what + " loaded the wrong table");
+        check(processor.get_register(3) == 5 && processor.get_register(5) == 1, what + " counted wrong");
+        check(processor.get_register(4) == 0xA && processor.get_register(6) == 0x3, what + " stored the wrong keys");
+    }
+
+    return chip8::test::exit_status();
+}